@@ -50,7 +50,7 @@ int main() {
         // compute the a^(2^(n-i-1)) mod N
         idx aj = modpow(a, j, N);
         // apply the controlled modular multiplication
-        psi = applyCTRL(psi, gt.MODMUL(aj, N, n), {i}, second_subsys);
+        psi = applyCTRL(psi, gt.MODMUL_perm(aj, N, n), {i}, second_subsys);
     }
 
     // apply inverse QFT on first half of the qubits
@@ -94,6 +94,11 @@ class QCircuit : public IDisplay, public IJSON {
 
         CUSTOM_cCTRL, ///< custom controlled gate with multiple controls and
         ///< multiple targets
+
+        PERM, ///< permutation of the basis states of multiple qudits, with
+        ///< optional (quantum) controls
+
+        DIAG, ///< diagonal gate on multiple qudits, specified by its diagonal
     };
 
     /**
@@ -161,6 +166,12 @@ class QCircuit : public IDisplay, public IJSON {
         case GateType::CUSTOM_cCTRL:
             os << "CUSTOM_cCTRL";
             break;
+        case GateType::PERM:
+            os << "PERM";
+            break;
+        case GateType::DIAG:
+            os << "DIAG";
+            break;
         }
 
         return os;
@@ -171,10 +182,12 @@ class QCircuit : public IDisplay, public IJSON {
      */
     struct GateStep {
         GateType gate_type_ = GateType::NONE; ///< gate type
-        cmat gate_;                           ///< gate
+        cmat gate_; ///< gate, or its diagonal as a column for DIAG gates
+        std::vector<idx> perm_;               ///< basis state permutation
         std::vector<idx> ctrl_;               ///< control
         std::vector<idx> target_; ///< target where the gate is applied
         std::string name_;        ///< custom name of the step
+        bool swap_ = true; ///< final swaps, for QFT/TFQ gates only
         /**
          * \brief Default constructor
          */
@@ -192,8 +205,22 @@ class QCircuit : public IDisplay, public IJSON {
         explicit GateStep(GateType gate_type, const cmat& gate,
                           const std::vector<idx>& ctrl,
                           const std::vector<idx>& target, std::string name = "")
-            : gate_type_{gate_type}, gate_{gate}, ctrl_{ctrl}, target_{target},
-              name_{name} {}
+            : gate_type_{gate_type}, gate_{gate}, perm_{}, ctrl_{ctrl},
+              target_{target}, name_{name}, swap_{true} {}
+        /**
+         * \brief Constructs a permutation gate step instance
+         *
+         * \param gate_type Gate type
+         * \param perm Permutation of the basis states of the target
+         * \param ctrl Control qudit indexes
+         * \param target Target qudit indexes
+         * \param name Optional gate name
+         */
+        explicit GateStep(GateType gate_type, const std::vector<idx>& perm,
+                          const std::vector<idx>& ctrl,
+                          const std::vector<idx>& target, std::string name = "")
+            : gate_type_{gate_type}, gate_{}, perm_{perm}, ctrl_{ctrl},
+              target_{target}, name_{name}, swap_{true} {}
     };
 
     /**
@@ -1077,20 +1104,35 @@ class QCircuit : public IDisplay, public IJSON {
 
     // QFT
     /**
-     * \brief Applies the quantum Fourier transform (as a series of gates) on
-     * the qudit indexes specified by \a target
+     * \brief Applies the quantum Fourier transform on the qudit indexes
+     * specified by \a target
+     *
+     * \note Executed as one step, at the cost of one pass over the state per
+     * target qudit (instead of one per gate of the textbook circuit)
      *
      * \param target Subsystem indexes where the quantum Fourier transform is
      * applied
-     * \param swap Swaps the qubits at the end (true by default)
+     * \param swap Swaps the qudits at the end (true by default)
      * \return Reference to the current instance
      */
-    QCircuit& QFT(const std::vector<idx>& target,
-                  bool swap QPP_UNUSED_ = true) {
+    QCircuit& QFT(const std::vector<idx>& target, bool swap = true) {
         // EXCEPTION CHECKS
 
         try {
-            throw exception::NotImplemented("qpp::QCircuit::QFT()");
+            // check valid target
+            if (target.size() == 0)
+                throw exception::ZeroSize("qpp::QCircuit::QFT()");
+            for (auto&& elem : target) {
+                if (elem >= nq_)
+                    throw exception::OutOfRange("qpp::QCircuit::QFT()");
+                // check target was not measured before
+                if (get_measured(elem))
+                    throw exception::QuditAlreadyMeasured(
+                        "qpp::QCircuit::QFT()");
+            }
+            // check no duplicates target
+            if (!internal::check_no_duplicates(target))
+                throw exception::Duplicates("qpp::QCircuit::QFT()");
         } catch (exception::Exception&) {
             std::cerr << "At STEP " << get_step_count() << "\n";
             throw;
@@ -1099,6 +1141,7 @@ class QCircuit : public IDisplay, public IJSON {
 
         gates_.emplace_back(GateType::QFT, cmat{}, std::vector<idx>{}, target,
                             "QFT");
+        gates_.back().swap_ = swap;
         step_types_.push_back(StepType::GATE);
 
         return *this;
@@ -1106,27 +1149,44 @@ class QCircuit : public IDisplay, public IJSON {
 
     // TFQ
     /**
-     * \brief Applies the inverse quantum Fourier transform (as a series of
-     * gates) on the qudit indexes specified by \a target
+     * \brief Applies the inverse quantum Fourier transform on the qudit indexes
+     * specified by \a target
+     *
+     * \note Executed as one step, at the cost of one pass over the state per
+     * target qudit (instead of one per gate of the textbook circuit)
      *
      * \param target Subsystem indexes where the inverse quantum Fourier
      * transform is applied
-     * \param swap Swaps the qubits at the end (true by default)
+     * \param swap Swaps the qudits at the beginning (true by default)
      * \return Reference to the current instance
      */
-    QCircuit& TFQ(const std::vector<idx>& target,
-                  bool swap QPP_UNUSED_ = true) {
+    QCircuit& TFQ(const std::vector<idx>& target, bool swap = true) {
         // EXCEPTION CHECKS
 
         try {
-            throw exception::NotImplemented("qpp::QCircuit::TFQ()");
+            // check valid target
+            if (target.size() == 0)
+                throw exception::ZeroSize("qpp::QCircuit::TFQ()");
+            for (auto&& elem : target) {
+                if (elem >= nq_)
+                    throw exception::OutOfRange("qpp::QCircuit::TFQ()");
+                // check target was not measured before
+                if (get_measured(elem))
+                    throw exception::QuditAlreadyMeasured(
+                        "qpp::QCircuit::TFQ()");
+            }
+            // check no duplicates target
+            if (!internal::check_no_duplicates(target))
+                throw exception::Duplicates("qpp::QCircuit::TFQ()");
         } catch (exception::Exception&) {
             std::cerr << "At STEP " << get_step_count() << "\n";
             throw;
         }
         // END EXCEPTION CHECKS
+
         gates_.emplace_back(GateType::TFQ, cmat{}, std::vector<idx>{}, target,
                             "TFQ");
+        gates_.back().swap_ = swap;
         step_types_.push_back(StepType::GATE);
 
         return *this;
@@ -1737,6 +1797,161 @@ class QCircuit : public IDisplay, public IJSON {
         return *this;
     }
 
+    /**
+     * \brief Applies the permutation gate \a perm on the qudit indexes
+     * specified by \a target, depending on the values of the control qudits
+     * \see qpp::applyCTRL() for permutation gates
+     *
+     * The gate maps the basis state \f$|m\rangle\f$ of \a target to
+     * \f$|perm[m]\rangle\f$, and is executed without constructing its
+     * matrix.
+     *
+     * \param perm Permutation of the basis states of \a target
+     * \param ctrl Control qudit indexes, may be empty
+     * \param target Target qudit indexes where the gate is applied
+     * \param name Optional gate name, default is "PERM"
+     * \return Reference to the current instance
+     */
+    QCircuit& CTRL_perm(const std::vector<idx>& perm,
+                        const std::vector<idx>& ctrl,
+                        const std::vector<idx>& target,
+                        std::string name = "") {
+        // EXCEPTION CHECKS
+
+        idx n = static_cast<idx>(target.size());
+        idx D = static_cast<idx>(std::llround(std::pow(d_, n)));
+
+        try {
+            // check valid ctrl
+            for (auto&& elem : ctrl) {
+                if (elem >= nq_)
+                    throw exception::OutOfRange("qpp::QCircuit::CTRL_perm()");
+                // check ctrl was not measured before
+                if (get_measured(elem))
+                    throw exception::QuditAlreadyMeasured(
+                        "qpp::QCircuit::CTRL_perm()");
+            }
+            // check no duplicates ctrl
+            if (!internal::check_no_duplicates(ctrl))
+                throw exception::Duplicates("qpp::QCircuit::CTRL_perm()");
+
+            // check valid target
+            if (target.size() == 0)
+                throw exception::ZeroSize("qpp::QCircuit::CTRL_perm()");
+            for (auto&& elem : target) {
+                if (elem >= nq_)
+                    throw exception::OutOfRange("qpp::QCircuit::CTRL_perm()");
+                // check target was not measured before
+                if (get_measured(elem))
+                    throw exception::QuditAlreadyMeasured(
+                        "qpp::QCircuit::CTRL_perm()");
+            }
+            // check no duplicates target
+            if (!internal::check_no_duplicates(target))
+                throw exception::Duplicates("qpp::QCircuit::CTRL_perm()");
+
+            // check ctrl and target don't share common elements
+            for (auto&& elem_ctrl : ctrl)
+                for (auto&& elem_target : target)
+                    if (elem_ctrl == elem_target)
+                        throw exception::OutOfRange(
+                            "qpp::QCircuit::CTRL_perm()");
+
+            // check valid permutation
+            if (!internal::check_perm(perm))
+                throw exception::PermInvalid("qpp::QCircuit::CTRL_perm()");
+            // check correct dimension
+            if (perm.size() != D)
+                throw exception::PermMismatchDims(
+                    "qpp::QCircuit::CTRL_perm()");
+        } catch (exception::Exception&) {
+            std::cerr << "At STEP " << get_step_count() << "\n";
+            throw;
+        }
+        // END EXCEPTION CHECKS
+
+        if (name == "")
+            name = "PERM";
+        gates_.emplace_back(GateType::PERM, perm, ctrl, target, name);
+        step_types_.push_back(StepType::GATE);
+
+        return *this;
+    }
+
+    /**
+     * \brief Applies the permutation gate \a perm on the qudit indexes
+     * specified by \a target
+     * \see qpp::QCircuit::CTRL_perm()
+     *
+     * \param perm Permutation of the basis states of \a target
+     * \param target Target qudit indexes where the gate is applied
+     * \param name Optional gate name, default is "PERM"
+     * \return Reference to the current instance
+     */
+    QCircuit& gate_perm(const std::vector<idx>& perm,
+                        const std::vector<idx>& target,
+                        std::string name = "") {
+        return CTRL_perm(perm, {}, target, name);
+    }
+
+    /**
+     * \brief Applies the diagonal gate with diagonal \a diag on the qudit
+     * indexes specified by \a target
+     *
+     * The amplitude of the basis state \f$|m\rangle\f$ of \a target is
+     * multiplied by \a diag(m), as one elementwise multiplication over the
+     * state vector.
+     *
+     * \note Dense diagonal gates are recognized and applied in the same way,
+     * see also qpp::QCircuit::fuse_diag()
+     *
+     * \param diag Diagonal of the gate
+     * \param target Target qudit indexes where the gate is applied
+     * \param name Optional gate name, default is "DIAG"
+     * \return Reference to the current instance
+     */
+    QCircuit& gate_diag(const ket& diag, const std::vector<idx>& target,
+                        std::string name = "") {
+        // EXCEPTION CHECKS
+
+        idx n = static_cast<idx>(target.size());
+        idx D = static_cast<idx>(std::llround(std::pow(d_, n)));
+
+        try {
+            // check valid target
+            if (target.size() == 0)
+                throw exception::ZeroSize("qpp::QCircuit::gate_diag()");
+            for (auto&& elem : target) {
+                if (elem >= nq_)
+                    throw exception::OutOfRange("qpp::QCircuit::gate_diag()");
+                // check target was not measured before
+                if (get_measured(elem))
+                    throw exception::QuditAlreadyMeasured(
+                        "qpp::QCircuit::gate_diag()");
+            }
+            // check no duplicates target
+            if (!internal::check_no_duplicates(target))
+                throw exception::Duplicates("qpp::QCircuit::gate_diag()");
+
+            // check correct dimension
+            if (static_cast<idx>(diag.size()) != D)
+                throw exception::DimsMismatchCvector(
+                    "qpp::QCircuit::gate_diag()");
+        } catch (exception::Exception&) {
+            std::cerr << "At STEP " << get_step_count() << "\n";
+            throw;
+        }
+        // END EXCEPTION CHECKS
+
+        if (name == "")
+            name = "DIAG";
+        gates_.emplace_back(GateType::DIAG, cmat{diag}, std::vector<idx>{},
+                            target, name);
+        step_types_.push_back(StepType::GATE);
+
+        return *this;
+    }
+
     // Z measurement of single qudit
     /**
      * \brief Measurement of single qudit in the computational basis (Z-basis)
@@ -1879,6 +2094,321 @@ class QCircuit : public IDisplay, public IJSON {
         return *this;
     }
 
+    /**
+     * \brief Gate fusion pass
+     *
+     * Merges runs of consecutive quantum gates into single custom gates
+     * acting on at most \a max_width qudits, so that executing the resulting
+     * circuit requires fewer passes over the state vector. Measurements and
+     * classically-controlled gates are never merged and act as fusion
+     * boundaries, and so do gates acting on more than \a max_width qudits.
+     * Gates that end up alone in their run are copied unchanged.
+     *
+     * \note Execute the fused circuit with a qpp::QEngine constructed from
+     * the returned circuit, i.e. QCircuit fused = qc.fuse(); QEngine
+     * engine{fused};
+     *
+     * \param max_width Maximum number of qudits a fused gate acts on
+     * \return Equivalent quantum circuit with fused gates
+     */
+    QCircuit fuse(idx max_width = 4) const {
+        // EXCEPTION CHECKS
+
+        if (max_width == 0)
+            throw exception::OutOfRange("qpp::QCircuit::fuse()");
+        // END EXCEPTION CHECKS
+
+        QCircuit result{nq_, nc_, d_, name_};
+        result.measured_ = measured_;
+
+        // the run of gates currently being fused
+        std::vector<const GateStep*> run_steps;
+        std::vector<idx> run_qudits; // qudits, in order of appearance
+        cmat run_U;                  // the fused gate on run_qudits
+
+        // writes the current run into the result
+        auto flush = [&]() {
+            if (run_steps.empty())
+                return;
+            if (run_steps.size() == 1)
+                result.gates_.push_back(*run_steps[0]);
+            else
+                result.gates_.emplace_back(GateType::CUSTOM, run_U,
+                                           std::vector<idx>{}, run_qudits,
+                                           "FUSED");
+            result.step_types_.push_back(StepType::GATE);
+            run_steps.clear();
+            run_qudits.clear();
+        };
+
+        idx gates_ip = 0;
+        idx measurements_ip = 0;
+        for (auto&& step_type : step_types_) {
+            // measurement step, copy as is
+            if (step_type == StepType::MEASUREMENT) {
+                flush();
+                result.measurements_.push_back(
+                    measurements_[measurements_ip++]);
+                result.step_types_.push_back(StepType::MEASUREMENT);
+                continue;
+            }
+
+            const GateStep& gate_step = gates_[gates_ip++];
+
+            // only gates with a quantum action known at this point are fused
+            bool fusable = false;
+            switch (gate_step.gate_type_) {
+            case GateType::SINGLE:
+            case GateType::TWO:
+            case GateType::THREE:
+            case GateType::CUSTOM:
+            case GateType::FAN:
+            case GateType::SINGLE_CTRL_SINGLE_TARGET:
+            case GateType::SINGLE_CTRL_MULTIPLE_TARGET:
+            case GateType::MULTIPLE_CTRL_SINGLE_TARGET:
+            case GateType::MULTIPLE_CTRL_MULTIPLE_TARGET:
+            case GateType::CUSTOM_CTRL:
+            case GateType::DIAG:
+                fusable = true;
+                break;
+            default:
+                break;
+            }
+
+            std::vector<idx> qudits = gate_step.ctrl_;
+            qudits.insert(std::end(qudits), std::begin(gate_step.target_),
+                          std::end(gate_step.target_));
+
+            if (!fusable || qudits.size() > max_width) {
+                flush();
+                result.gates_.push_back(gate_step);
+                result.step_types_.push_back(StepType::GATE);
+                continue;
+            }
+
+            // qudits of the run extended by the ones of the current gate
+            std::vector<idx> merged = run_qudits;
+            for (auto&& elem : qudits)
+                if (std::find(std::begin(merged), std::end(merged), elem) ==
+                    std::end(merged))
+                    merged.emplace_back(elem);
+            if (merged.size() > max_width) {
+                flush();
+                merged = qudits;
+            }
+
+            // extend the fused gate by the identity on the new qudits
+            idx D_new = static_cast<idx>(
+                std::llround(std::pow(d_, merged.size() - run_qudits.size())));
+            if (run_steps.empty())
+                run_U = cmat::Identity(D_new, D_new);
+            else if (D_new > 1)
+                run_U = kron(run_U, cmat::Identity(D_new, D_new));
+            run_qudits = merged;
+
+            // positions of the gate qudits inside the run
+            auto local_pos = [&](const std::vector<idx>& v) {
+                std::vector<idx> pos(v.size());
+                for (idx i = 0; i < v.size(); ++i)
+                    pos[i] = static_cast<idx>(std::distance(
+                        std::begin(run_qudits),
+                        std::find(std::begin(run_qudits), std::end(run_qudits),
+                                  v[i])));
+                return pos;
+            };
+            std::vector<idx> ctrl_local = local_pos(gate_step.ctrl_);
+            std::vector<idx> target_local = local_pos(gate_step.target_);
+            std::vector<idx> dims_local(run_qudits.size(), d_);
+
+            // left-multiply the fused gate by the current one, column-wise
+            for (idx c = 0; c < static_cast<idx>(run_U.cols()); ++c) {
+                ket col = run_U.col(c);
+                if (gate_step.gate_type_ == GateType::FAN) {
+                    for (auto&& elem : target_local)
+                        internal::apply_ctrl_ket_inplace(col, gate_step.gate_,
+                                                         {}, {elem},
+                                                         dims_local);
+                } else if (gate_step.gate_type_ == GateType::DIAG) {
+                    internal::apply_diag_ket_inplace(
+                        col, {ket{gate_step.gate_}}, {}, target_local,
+                        dims_local);
+                } else {
+                    internal::apply_ctrl_ket_inplace(col, gate_step.gate_,
+                                                     ctrl_local, target_local,
+                                                     dims_local);
+                }
+                run_U.col(c) = col;
+            }
+            run_steps.push_back(&gate_step);
+        }
+        flush();
+
+        return result;
+    }
+
+    /**
+     * \brief Diagonal gate merging pass
+     *
+     * Merges runs of consecutive diagonal gates into single
+     * qpp::QCircuit::GateType::DIAG gates acting on at most \a max_width
+     * qudits, i.e. into single arrays of phases, each applied as one
+     * elementwise multiplication over the state vector. The diagonal gates
+     * are the gates with a diagonal matrix, including the ones with quantum
+     * controls, and the DIAG gates. Any other step acts as a boundary. Gates
+     * that end up alone in their run are copied unchanged.
+     *
+     * \note The phase array of a merged gate has \f$d^w\f$ entries, \f$w\f$
+     * being the number of qudits it acts on, hence \a max_width can be much
+     * larger than for qpp::QCircuit::fuse(); the two passes can be chained,
+     * i.e. qc.fuse_diag().fuse()
+     *
+     * \param max_width Maximum number of qudits a merged gate acts on
+     * \return Equivalent quantum circuit with merged diagonal gates
+     */
+    QCircuit fuse_diag(idx max_width = 16) const {
+        // EXCEPTION CHECKS
+
+        if (max_width == 0)
+            throw exception::OutOfRange("qpp::QCircuit::fuse_diag()");
+        // END EXCEPTION CHECKS
+
+        QCircuit result{nq_, nc_, d_, name_};
+        result.measured_ = measured_;
+
+        // the run of diagonal gates currently being merged
+        std::vector<const GateStep*> run_steps;
+        std::vector<idx> run_qudits; // qudits, in order of appearance
+        ket run_diag;                // the merged diagonal on run_qudits
+
+        // writes the current run into the result
+        auto flush = [&]() {
+            if (run_steps.empty())
+                return;
+            if (run_steps.size() == 1)
+                result.gates_.push_back(*run_steps[0]);
+            else
+                result.gates_.emplace_back(GateType::DIAG, cmat{run_diag},
+                                           std::vector<idx>{}, run_qudits,
+                                           "FUSED_DIAG");
+            result.step_types_.push_back(StepType::GATE);
+            run_steps.clear();
+            run_qudits.clear();
+        };
+
+        idx gates_ip = 0;
+        idx measurements_ip = 0;
+        for (auto&& step_type : step_types_) {
+            // measurement step, copy as is
+            if (step_type == StepType::MEASUREMENT) {
+                flush();
+                result.measurements_.push_back(
+                    measurements_[measurements_ip++]);
+                result.step_types_.push_back(StepType::MEASUREMENT);
+                continue;
+            }
+
+            const GateStep& gate_step = gates_[gates_ip++];
+
+            // the diagonal of the gate on its qudits (controls first), left
+            // empty if the gate is not diagonal
+            std::vector<idx> qudits;
+            ket diag;
+            idx DA = static_cast<idx>(
+                std::llround(std::pow(d_, gate_step.target_.size())));
+            switch (gate_step.gate_type_) {
+            case GateType::SINGLE:
+            case GateType::TWO:
+            case GateType::THREE:
+            case GateType::CUSTOM:
+            case GateType::SINGLE_CTRL_SINGLE_TARGET:
+            case GateType::SINGLE_CTRL_MULTIPLE_TARGET:
+            case GateType::MULTIPLE_CTRL_SINGLE_TARGET:
+            case GateType::MULTIPLE_CTRL_MULTIPLE_TARGET:
+            case GateType::CUSTOM_CTRL:
+                if (static_cast<idx>(gate_step.gate_.rows()) == DA &&
+                    internal::is_diagonal(gate_step.gate_)) {
+                    qudits = gate_step.ctrl_;
+                    qudits.insert(std::end(qudits),
+                                  std::begin(gate_step.target_),
+                                  std::end(gate_step.target_));
+                    // the k-th power acts when all controls are in |k>
+                    idx Dc = static_cast<idx>(
+                        std::llround(std::pow(d_, gate_step.ctrl_.size())));
+                    diag = ket::Ones(Dc * DA);
+                    if (Dc == 1)
+                        diag = gate_step.gate_.diagonal();
+                    else {
+                        ket power = ket::Ones(DA);
+                        idx c_one = (Dc - 1) / (d_ - 1); // all controls in |1>
+                        for (idx k = 1; k < d_; ++k) {
+                            power = power.cwiseProduct(
+                                gate_step.gate_.diagonal());
+                            diag.segment(k * c_one * DA, DA) = power;
+                        }
+                    }
+                }
+                break;
+            case GateType::FAN:
+                if (internal::is_diagonal(gate_step.gate_)) {
+                    qudits = gate_step.target_;
+                    diag = ket::Ones(1);
+                    for (idx i = 0; i < qudits.size(); ++i)
+                        diag = kron(diag, ket{gate_step.gate_.diagonal()});
+                }
+                break;
+            case GateType::DIAG:
+                qudits = gate_step.target_;
+                diag = gate_step.gate_;
+                break;
+            default:
+                break;
+            }
+
+            if (diag.size() == 0 || qudits.size() > max_width) {
+                flush();
+                result.gates_.push_back(gate_step);
+                result.step_types_.push_back(StepType::GATE);
+                continue;
+            }
+
+            // qudits of the run extended by the ones of the current gate
+            std::vector<idx> merged = run_qudits;
+            for (auto&& elem : qudits)
+                if (std::find(std::begin(merged), std::end(merged), elem) ==
+                    std::end(merged))
+                    merged.emplace_back(elem);
+            if (merged.size() > max_width) {
+                flush();
+                merged = qudits;
+            }
+
+            // extend the merged diagonal by ones on the new qudits
+            idx D_new = static_cast<idx>(
+                std::llround(std::pow(d_, merged.size() - run_qudits.size())));
+            if (run_steps.empty())
+                run_diag = ket::Ones(D_new);
+            else if (D_new > 1)
+                run_diag = kron(run_diag, ket::Ones(D_new));
+            run_qudits = merged;
+
+            // positions of the gate qudits inside the run, then multiply the
+            // merged diagonal by the one of the gate
+            std::vector<idx> pos(qudits.size());
+            for (idx i = 0; i < qudits.size(); ++i)
+                pos[i] = static_cast<idx>(std::distance(
+                    std::begin(run_qudits),
+                    std::find(std::begin(run_qudits), std::end(run_qudits),
+                              qudits[i])));
+            internal::apply_diag_ket_inplace(
+                run_diag, {diag}, {}, pos,
+                std::vector<idx>(run_qudits.size(), d_));
+            run_steps.push_back(&gate_step);
+        }
+        flush();
+
+        return result;
+    }
+
     /**
      * \brief qpp::IDisplay::display() override
      *
@@ -2002,18 +2532,39 @@ class QCircuit : public IDisplay, public IJSON {
 };    /* class QCircuit */
 
 /**
- * \class qpp::QEngine
+ * \class qpp::QEngineT
  * \brief Quantum circuit engine, executes qpp::QCircuit
- * \see qpp::QCircuit
+ * \see qpp::QCircuit, qpp::QEngine, qpp::QEngine_f
+ *
+ * The gates and the measurement bases of the circuit are stored in double
+ * precision, they are converted once to the precision of the state.
+ *
+ * \note For a qpp::MappedKet state, the gates, qpp::QEngineT::reset() and
+ * the sampling of qpp::QEngineT::run() work directly on the mapping. The
+ * measurements executed by qpp::QEngineT::execute() construct the
+ * post-measurement states in memory, of reduced size, before copying them
+ * back into the mapping.
+ *
+ * \tparam T State vector type, qpp::ket (double precision) or qpp::ket_f
+ * (single precision, half the memory), or qpp::MappedKet/qpp::MappedKet_f
+ * (stored in a memory-mapped file)
  */
-class QEngine : public IDisplay, public IJSON {
+template <typename T>
+class QEngineT : public IDisplay, public IJSON {
   protected:
+    using Scalar = typename T::Scalar; ///< scalar field of the state
+
     const QCircuit& qcd_;       ///< quantum circuit
-    ket psi_;                   ///< state vector
+    T psi_;                     ///< state vector
     std::vector<idx> dits_;     ///< classical dits
     std::vector<double> probs_; ///< measurement probabilities
     std::vector<idx> subsys_;   ///< keeps track of the measured subsystems,
                                 ///< relabel them after measurements
+    std::vector<std::vector<dyn_mat<Scalar>>> powers_; ///< cached gate
+                                                       ///< powers, one table
+                                                       ///< per gate step
+    idx renorm_period_;         ///< gate steps between renormalizations
+    idx gate_steps_;            ///< gate steps executed since the last reset
 
     /**
      * \brief Marks qudit \a i as measured then re-label accordingly the
@@ -2032,6 +2583,31 @@ class QEngine : public IDisplay, public IJSON {
         }
     }
 
+    /**
+     * \brief Table of powers \f$U^1, \ldots, U^k\f$ of the gate \f$U\f$ at
+     * position \a q_ip in the list of gates, computed once (in double
+     * precision) and then reused across executions
+     *
+     * \param q_ip Gate index
+     * \param k Highest power required
+     * \return Table of powers, of size at least \a k, in the precision of
+     * the state
+     */
+    const std::vector<dyn_mat<Scalar>>& get_powers_(idx q_ip, idx k) {
+        if (q_ip >= powers_.size())
+            powers_.resize(qcd_.get_gates().size());
+        std::vector<dyn_mat<Scalar>>& powers = powers_[q_ip];
+        if (powers.size() < k) {
+            const cmat& U = qcd_.get_gates()[q_ip].gate_;
+            std::vector<cmat> Uk = internal::gate_powers(U, k);
+            powers.clear();
+            for (auto&& elem : Uk)
+                powers.emplace_back(elem.template cast<Scalar>());
+        }
+
+        return powers;
+    }
+
     // giving a vector of non-measured qudits, get their relative position wrt
     // the measured qudits
     /**
@@ -2051,6 +2627,70 @@ class QEngine : public IDisplay, public IJSON {
         return v;
     }
 
+    /**
+     * \brief Executes independent shots of the quantum circuit on copies of
+     * \a engine, distributed across threads, see qpp::QEngine::run_batch()
+     *
+     * \tparam Engine Dynamic type of the engine, so that the copies behave as
+     * \a engine does
+     * \param engine Engine to be copied, one copy per thread
+     * \param shots Number of shots
+     * \param seed Master seed
+     * \return Histogram of the classical dits
+     */
+    template <typename Engine>
+    static std::map<std::vector<idx>, idx>
+    run_batch_(const Engine& engine, idx shots,
+               std::mt19937::result_type seed) {
+        std::map<std::vector<idx>, idx> result;
+
+        // the shots can run in parallel only if each thread has its own
+        // random number generator
+#if defined(WITH_OPENMP_) && !defined(NO_THREAD_LOCAL_)
+#pragma omp parallel
+#endif // defined(WITH_OPENMP_) && !defined(NO_THREAD_LOCAL_)
+        {
+            Engine local_engine{engine};
+            std::map<std::vector<idx>, idx> partial;
+            auto& gen =
+#ifdef NO_THREAD_LOCAL_
+                RandomDevices::get_instance().get_prng();
+#else
+                RandomDevices::get_thread_local_instance().get_prng();
+#endif
+            std::mt19937 saved_gen = gen;
+
+#if defined(WITH_OPENMP_) && !defined(NO_THREAD_LOCAL_)
+#pragma omp for nowait
+#endif // defined(WITH_OPENMP_) && !defined(NO_THREAD_LOCAL_)
+            for (idx shot = 0; shot < shots; ++shot) {
+                // the random stream of each shot depends only on the master
+                // seed and on the shot index, not on the thread running it
+                unsigned long long shot_ull = shot;
+                std::seed_seq seq{
+                    seed,
+                    static_cast<std::mt19937::result_type>(shot_ull),
+                    static_cast<std::mt19937::result_type>(shot_ull >> 32)};
+                gen.seed(seq);
+                local_engine.reset();
+                for (auto&& elem : local_engine.get_circuit())
+                    local_engine.execute(elem);
+                ++partial[local_engine.get_dits()];
+            }
+            gen = saved_gen;
+
+#if defined(WITH_OPENMP_) && !defined(NO_THREAD_LOCAL_)
+#pragma omp critical
+#endif // defined(WITH_OPENMP_) && !defined(NO_THREAD_LOCAL_)
+            {
+                for (auto&& elem : partial)
+                    result[elem.first] += elem.second;
+            }
+        }
+
+        return result;
+    }
+
   public:
     /**
      * \brief Constructs a quantum engine out of a quantum circuit
@@ -2063,38 +2703,74 @@ class QEngine : public IDisplay, public IJSON {
      *
      * \param qcd Quantum circuit
      */
-    explicit QEngine(const QCircuit& qcd)
-        : qcd_{qcd}, psi_{States::get_instance().zero(qcd.get_nq(),
-                                                      qcd.get_d())},
+    explicit QEngineT(const QCircuit& qcd)
+        : qcd_{qcd}, psi_{States::get_instance()
+                              .zero(qcd.get_nq(), qcd.get_d())
+                              .template cast<Scalar>()},
           dits_(qcd.get_nc(), 0), probs_(qcd.get_nc(), 0),
-          subsys_(qcd.get_nq(), 0) {
+          subsys_(qcd.get_nq(), 0), powers_(qcd.get_gates().size()),
+          renorm_period_{0}, gate_steps_{0} {
         std::iota(std::begin(subsys_), std::end(subsys_), 0);
     }
 
+    /**
+     * \brief Constructs a quantum engine out of a quantum circuit, with the
+     * initial state \a psi
+     *
+     * \note The quantum circuit must be an lvalue
+     *
+     * \note Resetting the engine, see qpp::QEngine::reset(), sets the state to
+     * \f$|0\rangle^{\otimes n}\f$
+     *
+     * \param qcd Quantum circuit
+     * \param psi Initial state, e.g. a qpp::MappedKet restored from a
+     * checkpoint, moved into the engine
+     */
+    QEngineT(const QCircuit& qcd, T psi)
+        : qcd_{qcd}, psi_{std::move(psi)}, dits_(qcd.get_nc(), 0),
+          probs_(qcd.get_nc(), 0), subsys_(qcd.get_nq(), 0),
+          powers_(qcd.get_gates().size()), renorm_period_{0}, gate_steps_{0} {
+        // EXCEPTION CHECKS
+
+        if (!internal::check_cvector(psi_))
+            throw exception::MatrixNotCvector("qpp::QEngine::QEngine()");
+        if (!internal::check_dims_match_cvect(
+                std::vector<idx>(qcd.get_nq(), qcd.get_d()), psi_))
+            throw exception::DimsMismatchCvector("qpp::QEngine::QEngine()");
+        // END EXCEPTION CHECKS
+
+        std::iota(std::begin(subsys_), std::end(subsys_), 0);
+    }
+
+    /**
+     * \brief Disables rvalue QCircuit
+     */
+    QEngineT(QCircuit&&) = delete;
+
     /**
      * \brief Disables rvalue QCircuit
      */
-    QEngine(QCircuit&&) = delete;
+    QEngineT(QCircuit&&, T) = delete;
 
     /**
      * \brief Default virtual destructor
      */
-    virtual ~QEngine() = default;
+    virtual ~QEngineT() = default;
 
     // getters
     /**
      * \brief Underlying quantum state
      *
-     * \return Underlying quantum state
+     * \return Copy of the underlying quantum state, in memory
      */
-    ket get_psi() const { return psi_; }
+    dyn_col_vect<Scalar> get_psi() const { return psi_; }
 
     /**
      * \brief Reference to the underlying quantum state
      *
      * \return Reference to the underlying quantum state
      */
-    ket& get_ref_psi() { return psi_; }
+    T& get_ref_psi() { return psi_; }
 
     /**
      * \brief Vector with the values of the underlying classical dits
@@ -2181,13 +2857,30 @@ class QEngine : public IDisplay, public IJSON {
      * \param value Classical dit value
      * \return Reference to the current instance
      */
-    QEngine& set_dit(idx i, idx value) {
+    QEngineT& set_dit(idx i, idx value) {
         if (i > qcd_.get_nc())
             throw exception::OutOfRange("qpp::QEngine::set_dit()");
         dits_[i] = value;
 
         return *this;
     }
+
+    /**
+     * \brief Renormalizes the state every \a period gate steps
+     *
+     * The squared norm is accumulated in double precision, see
+     * qpp::internal::renormalize_ket(). Intended for single precision
+     * states, whose norm drifts with the number of gates applied.
+     *
+     * \param period Number of gate steps between two renormalizations, 0
+     * (the default) disables the renormalization
+     * \return Reference to the current instance
+     */
+    QEngineT& set_renormalization(idx period) {
+        renorm_period_ = period;
+
+        return *this;
+    }
     // end setters
 
     /**
@@ -2196,8 +2889,13 @@ class QEngine : public IDisplay, public IJSON {
      * Re-initializes everything to zero and sets the initial state to
      * \f$|0\rangle^{\otimes n}\f$
      */
-    void reset() {
-        psi_ = States::get_instance().zero(qcd_.get_nq(), qcd_.get_d());
+    virtual void reset() {
+        // nullary expression, written directly into the state (e.g. into the
+        // mapping of a qpp::MappedKet), no intermediate state in memory
+        idx D = static_cast<idx>(
+            std::llround(std::pow(qcd_.get_d(), qcd_.get_nq())));
+        psi_ = dyn_col_vect<Scalar>::Unit(static_cast<Eigen::Index>(D), 0);
+        gate_steps_ = 0;
         dits_ = std::vector<idx>(qcd_.get_nc(), 0);
         probs_ = std::vector<double>(qcd_.get_nc(), 0);
         std::iota(std::begin(subsys_), std::end(subsys_), 0);
@@ -2225,7 +2923,7 @@ class QEngine : public IDisplay, public IJSON {
      *
      * \param elem Step to be executed
      */
-    void execute(const QCircuit::iterator::value_type& elem) {
+    virtual void execute(const QCircuit::iterator::value_type& elem) {
         // EXCEPTION CHECKS
 
         // iterator must point to the same quantum circuit
@@ -2236,39 +2934,48 @@ class QEngine : public IDisplay, public IJSON {
 
         // gate step
         if (elem.type_ == QCircuit::StepType::GATE) {
-            auto gates = qcd_.get_gates();
-            idx q_ip =
-                std::distance(std::begin(qcd_.get_gates()), elem.gates_ip_);
+            // reference, no copy of the gate list
+            const QCircuit::GateStep& gate_step = *elem.gates_ip_;
+            idx q_ip = static_cast<idx>(
+                std::distance(std::begin(qcd_.get_gates()), elem.gates_ip_));
 
             std::vector<idx> ctrl_rel_pos;
             std::vector<idx> target_rel_pos =
-                get_relative_pos_(gates[q_ip].target_);
+                get_relative_pos_(gate_step.target_);
+            std::vector<idx> dims(get_not_measured().size(), qcd_.get_d());
 
-            switch (gates[q_ip].gate_type_) {
+            switch (gate_step.gate_type_) {
             case QCircuit::GateType::NONE:
                 break;
             case QCircuit::GateType::SINGLE:
             case QCircuit::GateType::TWO:
             case QCircuit::GateType::THREE:
             case QCircuit::GateType::CUSTOM:
-                psi_ = apply(psi_, gates[q_ip].gate_, target_rel_pos,
-                             qcd_.get_d());
+                internal::apply_ctrl_ket_inplace(psi_, get_powers_(q_ip, 1),
+                                                 {}, target_rel_pos, dims);
                 break;
             case QCircuit::GateType::FAN:
-                for (idx m = 0; m < gates[q_ip].target_.size(); ++m)
-                    psi_ = apply(psi_, gates[q_ip].gate_, {target_rel_pos[m]},
-                                 qcd_.get_d());
+                for (idx m = 0; m < gate_step.target_.size(); ++m)
+                    internal::apply_ctrl_ket_inplace(
+                        psi_, get_powers_(q_ip, 1), {}, {target_rel_pos[m]},
+                        dims);
                 break;
             case QCircuit::GateType::QFT:
             case QCircuit::GateType::TFQ:
+                internal::apply_qft_ket_inplace(
+                    psi_, target_rel_pos, dims,
+                    gate_step.gate_type_ == QCircuit::GateType::TFQ,
+                    gate_step.swap_);
+                break;
             case QCircuit::GateType::SINGLE_CTRL_SINGLE_TARGET:
             case QCircuit::GateType::SINGLE_CTRL_MULTIPLE_TARGET:
             case QCircuit::GateType::MULTIPLE_CTRL_SINGLE_TARGET:
             case QCircuit::GateType::MULTIPLE_CTRL_MULTIPLE_TARGET:
             case QCircuit::GateType::CUSTOM_CTRL:
-                ctrl_rel_pos = get_relative_pos_(gates[q_ip].ctrl_);
-                psi_ = applyCTRL(psi_, gates[q_ip].gate_, ctrl_rel_pos,
-                                 target_rel_pos, qcd_.get_d());
+                ctrl_rel_pos = get_relative_pos_(gate_step.ctrl_);
+                internal::apply_ctrl_ket_inplace(
+                    psi_, get_powers_(q_ip, std::max(qcd_.get_d() - 1, idx{1})),
+                    ctrl_rel_pos, target_rel_pos, dims);
                 break;
             case QCircuit::GateType::SINGLE_cCTRL_SINGLE_TARGET:
             case QCircuit::GateType::SINGLE_cCTRL_MULTIPLE_TARGET:
@@ -2276,68 +2983,86 @@ class QEngine : public IDisplay, public IJSON {
             case QCircuit::GateType::MULTIPLE_cCTRL_MULTIPLE_TARGET:
             case QCircuit::GateType::CUSTOM_cCTRL:
                 if (dits_.size() == 0) {
-                    psi_ = apply(psi_, gates[q_ip].gate_, target_rel_pos,
-                                 qcd_.get_d());
+                    internal::apply_ctrl_ket_inplace(
+                        psi_, get_powers_(q_ip, 1), {}, target_rel_pos, dims);
                 } else {
                     bool should_apply = true;
-                    idx first_dit = dits_[(gates[q_ip].ctrl_)[0]];
-                    for (idx m = 0; m < gates[q_ip].ctrl_.size(); ++m) {
-                        if (dits_[(gates[q_ip].ctrl_)[m]] != first_dit) {
+                    idx first_dit = dits_[(gate_step.ctrl_)[0]];
+                    for (idx m = 0; m < gate_step.ctrl_.size(); ++m) {
+                        if (dits_[(gate_step.ctrl_)[m]] != first_dit) {
                             should_apply = false;
                             break;
                         }
                     }
-                    if (should_apply) {
-                        psi_ = apply(psi_, powm(gates[q_ip].gate_, first_dit),
-                                     target_rel_pos, qcd_.get_d());
+                    // A^0 is the identity, nothing to do
+                    if (should_apply && first_dit != 0) {
+                        const dyn_mat<Scalar>& U =
+                            get_powers_(q_ip, first_dit)[first_dit - 1];
+                        internal::apply_ctrl_ket_inplace(psi_, U, {},
+                                                         target_rel_pos, dims);
                     }
                 }
                 break;
+            case QCircuit::GateType::DIAG:
+                internal::apply_diag_ket_inplace(
+                    psi_,
+                    {dyn_col_vect<Scalar>(
+                        gate_step.gate_.template cast<Scalar>())},
+                    {}, target_rel_pos, dims);
+                break;
+            case QCircuit::GateType::PERM:
+                ctrl_rel_pos = get_relative_pos_(gate_step.ctrl_);
+                internal::apply_perm_ket_inplace(psi_, gate_step.perm_,
+                                                 ctrl_rel_pos, target_rel_pos,
+                                                 dims);
+                break;
             } // end switch on gate type
-        }     // end if gate step
+
+            if (renorm_period_ > 0 && ++gate_steps_ % renorm_period_ == 0)
+                internal::renormalize_ket(psi_);
+        } // end if gate step
         // measurement step
         else if (elem.type_ == QCircuit::StepType::MEASUREMENT) {
-            auto measurements = qcd_.get_measurements();
-            idx m_ip = std::distance(std::begin(qcd_.get_measurements()),
-                                     elem.measurements_ip_);
+            // reference, no copy of the measurement list
+            const QCircuit::MeasureStep& measure_step = *elem.measurements_ip_;
 
             std::vector<idx> target_rel_pos =
-                get_relative_pos_(measurements[m_ip].target_);
+                get_relative_pos_(measure_step.target_);
 
             std::vector<idx> resZ;
             double probZ;
 
             idx mres = 0;
             std::vector<double> probs;
-            std::vector<cmat> states;
+            std::vector<dyn_mat<Scalar>> states;
 
-            switch (measurements[m_ip].measurement_type_) {
+            switch (measure_step.measurement_type_) {
             case QCircuit::MeasureType::NONE:
                 break;
             case QCircuit::MeasureType::MEASURE_Z:
                 std::tie(resZ, probZ, psi_) =
                     measure_seq(psi_, target_rel_pos, qcd_.get_d());
-                dits_[measurements[m_ip].c_reg_] = resZ[0];
-                probs_[measurements[m_ip].c_reg_] = probZ;
-                set_measured_(measurements[m_ip].target_[0]);
+                dits_[measure_step.c_reg_] = resZ[0];
+                probs_[measure_step.c_reg_] = probZ;
+                set_measured_(measure_step.target_[0]);
                 break;
             case QCircuit::MeasureType::MEASURE_V:
                 std::tie(mres, probs, states) =
-                    measure(psi_, measurements[m_ip].mats_[0], target_rel_pos,
+                    measure(psi_, measure_step.mats_[0], target_rel_pos,
                             qcd_.get_d());
                 psi_ = states[mres];
-                dits_[measurements[m_ip].c_reg_] = mres;
-                probs_[measurements[m_ip].c_reg_] = probs[mres];
-                set_measured_(measurements[m_ip].target_[0]);
+                dits_[measure_step.c_reg_] = mres;
+                probs_[measure_step.c_reg_] = probs[mres];
+                set_measured_(measure_step.target_[0]);
                 break;
             case QCircuit::MeasureType::MEASURE_V_MANY:
                 std::tie(mres, probs, states) =
-                    measure(psi_, measurements[m_ip].mats_[0], target_rel_pos,
+                    measure(psi_, measure_step.mats_[0], target_rel_pos,
                             qcd_.get_d());
                 psi_ = states[mres];
-                dits_[measurements[m_ip].c_reg_] = mres;
-                probs_[measurements[m_ip].c_reg_] = probs[mres];
-                for (auto&& elem : measurements[m_ip].target_)
+                dits_[measure_step.c_reg_] = mres;
+                probs_[measure_step.c_reg_] = probs[mres];
+                for (auto&& elem : measure_step.target_)
                     set_measured_(elem);
                 break;
             } // end switch on measurement type
@@ -2354,6 +3079,174 @@ class QEngine : public IDisplay, public IJSON {
      */
     void execute(const QCircuit::iterator& it) { execute(*it); }
 
+    /**
+     * \brief Executes the quantum circuit \a shots times
+     *
+     * If all measurements are terminal, i.e. no gate follows a measurement
+     * and no measurement is fed forward, and all measurement bases are
+     * orthonormal, the unitary part of the circuit is simulated only once and
+     * all shots are sampled from the final probability distribution.
+     * Otherwise the circuit is re-simulated for each shot.
+     *
+     * \note The engine is reset before the simulation. If the circuit was
+     * simulated only once, the underlying state is the one right before the
+     * measurements (up to rounding), otherwise it is the final state of the
+     * last shot.
+     *
+     * \note The measurement bases are rotated in place and the shots are
+     * sampled in a streaming pass over the state; apart from the state, the
+     * memory used is proportional to \a shots. Hence a qpp::MappedKet state
+     * is never copied in memory.
+     *
+     * \param shots Number of shots
+     * \return Histogram of the classical dits, i.e. a map from each observed
+     * vector of classical dits to the number of times it occurred
+     */
+    virtual std::map<std::vector<idx>, idx> run(idx shots = 1) {
+        std::map<std::vector<idx>, idx> result;
+
+        const std::vector<QCircuit::MeasureStep>& measurements =
+            qcd_.get_measurements();
+
+        // check whether all measurements are terminal and in orthonormal
+        // bases
+        bool terminal = true;
+        bool measurement_seen = false;
+        for (auto&& elem : qcd_) {
+            if (elem.type_ == QCircuit::StepType::MEASUREMENT) {
+                measurement_seen = true;
+                const QCircuit::MeasureStep& measure_step =
+                    *elem.measurements_ip_;
+                if (measure_step.measurement_type_ !=
+                        QCircuit::MeasureType::MEASURE_Z &&
+                    !measure_step.mats_[0].isUnitary())
+                    terminal = false;
+            } else if (elem.type_ == QCircuit::StepType::GATE &&
+                       measurement_seen)
+                terminal = false;
+            if (!terminal)
+                break;
+        }
+
+        // re-simulate every shot
+        if (!terminal) {
+            for (idx shot = 0; shot < shots; ++shot) {
+                reset();
+                for (auto&& elem : qcd_)
+                    execute(elem);
+                ++result[dits_];
+            }
+
+            return result;
+        }
+
+        // simulate the unitary part once
+        reset();
+        auto it = qcd_.begin();
+        for (; it != qcd_.end(); ++it) {
+            if ((*it).type_ == QCircuit::StepType::MEASUREMENT)
+                break;
+            execute(it);
+        }
+
+        // rotate the measurement bases into the computational basis, in place
+        std::vector<idx> dims(qcd_.get_nq(), qcd_.get_d());
+        for (auto&& measure_step : measurements)
+            if (measure_step.measurement_type_ !=
+                QCircuit::MeasureType::MEASURE_Z)
+                internal::apply_ctrl_ket_inplace(
+                    psi_,
+                    dyn_mat<Scalar>(
+                        adjoint(measure_step.mats_[0]).template cast<Scalar>()),
+                    {}, measure_step.target_, dims);
+
+        // sample all shots in one streaming pass over the state: the sorted
+        // uniform variates are matched against the cumulative probabilities,
+        // so that no probability vector of full size is constructed
+        idx D = static_cast<idx>(psi_.size());
+        const Scalar* p = psi_.data();
+        double norm2 = 0;
+        for (idx i = 0; i < D; ++i)
+            norm2 += static_cast<double>(std::norm(p[i]));
+        auto& gen =
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+        std::uniform_real_distribution<double> ud(0, norm2);
+        std::vector<double> variates(shots);
+        for (auto&& variate : variates)
+            variate = ud(gen);
+        std::sort(std::begin(variates), std::end(variates));
+
+        std::map<idx, idx> counts;
+        double cumul = 0;
+        idx shot = 0, last = 0;
+        for (idx i = 0; i < D && shot < shots; ++i) {
+            double prob = static_cast<double>(std::norm(p[i]));
+            if (prob == 0)
+                continue;
+            cumul += prob;
+            last = i;
+            for (; shot < shots && variates[shot] < cumul; ++shot)
+                ++counts[i];
+        }
+        // rounding, the remaining variates fall on the last non-zero amplitude
+        if (shot < shots)
+            counts[last] += shots - shot;
+
+        // rotate back, so that the state is the one right before the
+        // measurements
+        for (auto it_m = measurements.rbegin(); it_m != measurements.rend();
+             ++it_m)
+            if (it_m->measurement_type_ != QCircuit::MeasureType::MEASURE_Z)
+                internal::apply_ctrl_ket_inplace(
+                    psi_,
+                    dyn_mat<Scalar>(it_m->mats_[0].template cast<Scalar>()),
+                    {}, it_m->target_, dims);
+
+        // convert basis states to classical dits
+        for (auto&& elem : counts) {
+            std::vector<idx> midx = n2multiidx(elem.first, dims);
+            std::vector<idx> dits = dits_;
+            for (auto&& measure_step : measurements) {
+                std::vector<idx> target_dits;
+                for (auto&& target : measure_step.target_)
+                    target_dits.emplace_back(midx[target]);
+                dits[measure_step.c_reg_] = multiidx2n(
+                    target_dits,
+                    std::vector<idx>(target_dits.size(), qcd_.get_d()));
+            }
+            result[dits] += elem.second;
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Executes \a shots independent shots of the quantum circuit,
+     * distributed across threads, reproducibly
+     *
+     * Each thread runs the shots on its own copy of the engine. Before each
+     * shot the random number generator of the thread is re-seeded from
+     * \a seed and the shot index, hence the result depends only on \a seed,
+     * and not on the number of threads or on the scheduling. The random
+     * number generators are restored afterwards.
+     *
+     * \note The circuit is re-simulated for each shot, see also
+     * qpp::QEngine::run(); the state of the current engine is not modified
+     *
+     * \param shots Number of shots
+     * \param seed Master seed
+     * \return Histogram of the classical dits, i.e. a map from each observed
+     * vector of classical dits to the number of times it occurred
+     */
+    virtual std::map<std::vector<idx>, idx>
+    run_batch(idx shots, std::mt19937::result_type seed) const {
+        return run_batch_(*this, shots, seed);
+    }
+
     /**
      * \brief qpp::IJOSN::to_JSON() override
      *
@@ -2393,7 +3286,225 @@ class QEngine : public IDisplay, public IJSON {
 
         return result;
     }
-}; /* class QEngine */
+}; /* class QEngineT */
+
+/**
+ * \brief Quantum circuit engine, double precision state vector
+ * \see qpp::QEngineT
+ */
+using QEngine = QEngineT<ket>;
+
+/**
+ * \brief Quantum circuit engine, single precision state vector
+ * \see qpp::QEngineT
+ */
+using QEngine_f = QEngineT<ket_f>;
+
+/**
+ * \class qpp::QNoisyEngineT
+ * \brief Noisy quantum circuit engine, executes qpp::QCircuit as quantum
+ * trajectories (Monte Carlo wavefunction simulation)
+ *
+ * After each gate step, \a GateNoise is applied independently on each
+ * non-measured qudit acted upon by the gate (targets and quantum controls),
+ * and \a IdleNoise is applied independently on each of the remaining
+ * non-measured qudits. Each noise application samples a single noise element
+ * and keeps the state pure, see qpp::NoiseBase::apply_trajectory(), so the
+ * memory cost is that of a state vector.
+ *
+ * \note The noise models must act on a single qudit of the circuit
+ * \tparam T State vector type, qpp::ket or qpp::ket_f, see qpp::QEngineT
+ * \tparam GateNoise Noise model of the qudits acted upon by gates, derived
+ * from qpp::NoiseBase
+ * \tparam IdleNoise Noise model of the idle qudits, derived from
+ * qpp::NoiseBase
+ */
+template <typename T, typename GateNoise, typename IdleNoise = GateNoise>
+class QNoisyEngineT : public QEngineT<T> {
+    using QEngineT<T>::qcd_;
+    using QEngineT<T>::psi_;
+    using QEngineT<T>::subsys_;
+    using QEngineT<T>::get_measured;
+    using QEngineT<T>::get_not_measured;
+
+    const GateNoise gate_noise_; ///< noise model of the gates
+    const IdleNoise idle_noise_; ///< noise model of the idle qudits
+    std::vector<std::vector<idx>> noise_results_; ///< noise elements that
+                                                  ///< occurred, one vector
+                                                  ///< per gate step
+
+    /**
+     * \brief Checks that the noise models match the qudit dimension
+     */
+    void check_noise_() const {
+        if (gate_noise_.get_d() != qcd_.get_d() ||
+            idle_noise_.get_d() != qcd_.get_d())
+            throw exception::DimsNotEqual(
+                "qpp::QNoisyEngine::QNoisyEngine()");
+    }
+
+  public:
+    /**
+     * \brief Constructs a noisy quantum engine out of a quantum circuit, the
+     * same noise model is used for the gates and the idle qudits
+     *
+     * \note The quantum circuit must be an lvalue
+     *
+     * \param qcd Quantum circuit
+     * \param noise Noise model
+     */
+    QNoisyEngineT(const QCircuit& qcd, const GateNoise& noise)
+        : QEngineT<T>{qcd}, gate_noise_{noise}, idle_noise_{noise},
+          noise_results_{} {
+        check_noise_();
+    }
+
+    /**
+     * \brief Constructs a noisy quantum engine out of a quantum circuit
+     *
+     * \note The quantum circuit must be an lvalue
+     *
+     * \param qcd Quantum circuit
+     * \param gate_noise Noise model of the qudits acted upon by gates
+     * \param idle_noise Noise model of the idle qudits
+     */
+    QNoisyEngineT(const QCircuit& qcd, const GateNoise& gate_noise,
+                  const IdleNoise& idle_noise)
+        : QEngineT<T>{qcd}, gate_noise_{gate_noise}, idle_noise_{idle_noise},
+          noise_results_{} {
+        check_noise_();
+    }
+
+    /**
+     * \brief Disables rvalue QCircuit
+     */
+    QNoisyEngineT(QCircuit&&, const GateNoise&) = delete;
+
+    /**
+     * \brief Disables rvalue QCircuit
+     */
+    QNoisyEngineT(QCircuit&&, const GateNoise&, const IdleNoise&) = delete;
+
+    // getters
+    /**
+     * \brief Indexes of the noise elements that occurred, one vector per
+     * executed gate step, listing the noise element of each non-measured
+     * qudit in increasing order of the qudit index
+     *
+     * \return Vector of noise results
+     */
+    std::vector<std::vector<idx>> get_noise_results() const {
+        return noise_results_;
+    }
+    // end getters
+
+    /**
+     * \brief qpp::QEngine::reset() override
+     */
+    void reset() override {
+        QEngineT<T>::reset();
+        noise_results_.clear();
+    }
+
+    using QEngineT<T>::execute;
+    /**
+     * \brief qpp::QEngine::execute() override, executes one step in the
+     * quantum circuit then applies the noise
+     *
+     * \param elem Step to be executed
+     */
+    void execute(const QCircuit::iterator::value_type& elem) override {
+        QEngineT<T>::execute(elem);
+        if (elem.type_ != QCircuit::StepType::GATE)
+            return;
+
+        // qudits acted upon by the gate, the controls of the classically
+        // controlled gates are classical dits
+        const QCircuit::GateStep& gate_step = *elem.gates_ip_;
+        std::vector<bool> acted(qcd_.get_nq(), false);
+        for (auto&& elem_target : gate_step.target_)
+            acted[elem_target] = true;
+        switch (gate_step.gate_type_) {
+        case QCircuit::GateType::SINGLE_cCTRL_SINGLE_TARGET:
+        case QCircuit::GateType::SINGLE_cCTRL_MULTIPLE_TARGET:
+        case QCircuit::GateType::MULTIPLE_cCTRL_SINGLE_TARGET:
+        case QCircuit::GateType::MULTIPLE_cCTRL_MULTIPLE_TARGET:
+        case QCircuit::GateType::CUSTOM_cCTRL:
+            break;
+        default:
+            for (auto&& elem_ctrl : gate_step.ctrl_)
+                acted[elem_ctrl] = true;
+            break;
+        }
+
+        std::vector<idx> dims(get_not_measured().size(), qcd_.get_d());
+        std::vector<idx> step_results;
+        for (idx i = 0; i < qcd_.get_nq(); ++i) {
+            if (get_measured(i))
+                continue;
+            std::vector<idx> target{subsys_[i]};
+            step_results.emplace_back(
+                acted[i] ? gate_noise_.apply_trajectory(psi_, target, dims)
+                         : idle_noise_.apply_trajectory(psi_, target, dims));
+        }
+        noise_results_.emplace_back(std::move(step_results));
+    }
+
+    /**
+     * \brief qpp::QEngine::run() override, executes \a shots independent
+     * quantum trajectories of the noisy quantum circuit
+     *
+     * The trajectories are distributed across threads, see
+     * qpp::QNoisyEngine::run_batch(), with a master seed drawn from the
+     * random number generator.
+     *
+     * \note The engine is reset, its state is left as after the reset
+     *
+     * \param shots Number of trajectories
+     * \return Histogram of the classical dits, i.e. a map from each observed
+     * vector of classical dits to the number of times it occurred
+     */
+    std::map<std::vector<idx>, idx> run(idx shots = 1) override {
+        reset();
+        auto& gen =
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+
+        return this->run_batch(shots, gen());
+    }
+
+    /**
+     * \brief qpp::QEngine::run_batch() override, executes \a shots
+     * independent quantum trajectories of the noisy quantum circuit,
+     * distributed across threads, reproducibly
+     *
+     * \param shots Number of trajectories
+     * \param seed Master seed
+     * \return Histogram of the classical dits, i.e. a map from each observed
+     * vector of classical dits to the number of times it occurred
+     */
+    std::map<std::vector<idx>, idx>
+    run_batch(idx shots, std::mt19937::result_type seed) const override {
+        return QEngineT<T>::run_batch_(*this, shots, seed);
+    }
+}; /* class QNoisyEngineT */
+
+/**
+ * \brief Noisy quantum circuit engine, double precision state vector
+ * \see qpp::QNoisyEngineT
+ */
+template <typename GateNoise, typename IdleNoise = GateNoise>
+using QNoisyEngine = QNoisyEngineT<ket, GateNoise, IdleNoise>;
+
+/**
+ * \brief Noisy quantum circuit engine, single precision state vector
+ * \see qpp::QNoisyEngineT
+ */
+template <typename GateNoise, typename IdleNoise = GateNoise>
+using QNoisyEngine_f = QNoisyEngineT<ket_f, GateNoise, IdleNoise>;
 
 } /* namespace qpp */
 
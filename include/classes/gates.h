@@ -284,21 +284,63 @@ class Gates final : public internal::Singleton<const Gates> // const Singleton
 
         cmat result = cmat::Zero(D, D);
 
-#ifdef WITH_OPENMP_
-#pragma omp parallel for collapse(2)
-#endif // WITH_OPENMP_
-       // column major order for speed
-        for (idx j = 0; j < N; ++j)
-            for (idx i = 0; i < N; ++i)
-                if (static_cast<idx>(modmul(j, a, N)) == i)
-                    result(i, j) = 1;
+        // one non-zero entry per column, see qpp::Gates::MODMUL_perm()
+        std::vector<idx> perm = MODMUL_perm(a, N, n);
+        for (idx j = 0; j < D; ++j)
+            result(perm[j], j) = 1;
 
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-       // complete the matrix
-        for (idx i = N; i < D; ++i)
-            result(i, i) = 1;
+        return result;
+    }
+
+    /**
+     * \brief Modular multiplication gate for qubits, as a permutation of the
+     * computational basis states
+     * Implements \f$ |x\rangle  \longrightarrow |ax \mathrm{ mod } N\rangle \f$
+     * for \f$ x < N \f$, and leaves \f$ |x\rangle \f$ unchanged for
+     * \f$ x \geq N \f$
+     *
+     * \see qpp::applyCTRL() and qpp::apply() for permutation gates, which
+     * apply the gate in \f$O(D)\f$ time without constructing its matrix
+     *
+     * \note For the gate to be unitary, \a a and \a N should be co-prime. The
+     * function does not check co-primality in release versions!
+     *
+     * \note The number of qubits required to implement the gate should satisfy
+     * \f$ n \geq \lceil\log_2(N)\rceil \f$
+     *
+     * \param a Positive integer less than \a N
+     * \param N Positive integer
+     * \param n Number of qubits required for implementing the gate
+     * \return Modular multiplication gate, as the vector of the images of
+     * the basis states \f$|0\rangle, \ldots, |2^n - 1\rangle\f$
+     */
+    std::vector<idx> MODMUL_perm(idx a, idx N, idx n) const {
+
+// check co-primality (unitarity) only in DEBUG version
+#ifndef NDEBUG
+        assert(gcd(a, N) == 1);
+#endif
+        // EXCEPTION CHECKS
+
+        // check valid arguments
+        if (N < 3 || a >= N) {
+            throw exception::OutOfRange("qpp::Gates::MODMUL_perm()");
+        }
+
+        // check enough qubits
+        if (n < static_cast<idx>(std::ceil(std::log2(N)))) {
+            throw exception::OutOfRange("qpp::Gates::MODMUL_perm()");
+        }
+        // END EXCEPTION CHECKS
+
+        idx D = static_cast<idx>(std::llround(std::pow(2, n)));
+
+        std::vector<idx> result(D);
+        for (idx j = 0; j < N; ++j)
+            result[j] = static_cast<idx>(modmul(j, a, N));
+        // complete the permutation
+        for (idx j = N; j < D; ++j)
+            result[j] = j;
 
         return result;
     }
@@ -452,14 +494,17 @@ class Gates final : public internal::Singleton<const Gates> // const Singleton
 
         dyn_mat<typename Derived::Scalar> result =
             dyn_mat<typename Derived::Scalar>::Identity(D, D);
-        dyn_mat<typename Derived::Scalar> Ak;
+        // the powers A^0, A^1, ..., A^(d-1), computed only once
+        std::vector<dyn_mat<typename Derived::Scalar>> Ak(d);
+        Ak[0] = dyn_mat<typename Derived::Scalar>::Identity(DA, DA);
+        for (idx k = 1; k < d; ++k)
+            Ak[k] = Ak[k - 1] * rA;
 
         // run over the complement indexes
         for (idx i = 0; i < Dsubsys_bar; ++i) {
             // get the complement row multi-index
             internal::n2multiidx(i, n_subsys_bar, Cdims_bar, midx_bar);
             for (idx k = 0; k < d; ++k) {
-                Ak = powm(rA, k); // compute rA^k
                 // run over the target row multi-index
                 for (idx a = 0; a < DA; ++a) {
                     // get the target row multi-index
@@ -492,7 +537,7 @@ class Gates final : public internal::Singleton<const Gates> // const Singleton
                         // finally write the values
                         result(internal::multiidx2n(midx_row, n, Cdims),
                                internal::multiidx2n(midx_col, n, Cdims)) =
-                            Ak(a, b);
+                            Ak[k](a, b);
                     }
                 }
             }
@@ -501,6 +546,141 @@ class Gates final : public internal::Singleton<const Gates> // const Singleton
         return result;
     }
 
+    /**
+     * \brief Generates the multi-partite multiple-controlled-\a A gate
+     * as a sparse matrix
+     * \see qpp::Gates::CTRL(), qpp::apply() for sparse gates
+     *
+     * \note The dimension of the gate \a A must match
+     * the dimension of \a target
+     *
+     * \note Only the non-zero entries are stored, i.e. at most
+     * \f$D\f$ entries outside the controlled blocks, instead of the
+     * \f$D^2\f$ entries of qpp::Gates::CTRL()
+     *
+     * \param A Eigen expression
+     * \param ctrl Control subsystem indexes
+     * \param target Subsystem indexes where the gate \a A is applied
+     * \param n Total number of subsystems
+     * \param d Subsystem dimensions
+     * \return CTRL-A gate, as a sparse matrix over the same scalar field as
+     * \a A
+     */
+    template <typename Derived>
+    dyn_sparse_mat<typename Derived::Scalar>
+    CTRL_sparse(const Eigen::MatrixBase<Derived>& A,
+                const std::vector<idx>& ctrl, const std::vector<idx>& target,
+                idx n, idx d = 2) const {
+        const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check matrix zero-size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::Gates::CTRL_sparse()");
+
+        // check square matrix
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare("qpp::Gates::CTRL_sparse()");
+
+        // check lists zero-size
+        if (ctrl.size() == 0)
+            throw exception::ZeroSize("qpp::Gates::CTRL_sparse()");
+        if (target.size() == 0)
+            throw exception::ZeroSize("qpp::Gates::CTRL_sparse()");
+
+        // check out of range
+        if (n == 0)
+            throw exception::OutOfRange("qpp::Gates::CTRL_sparse()");
+
+        // check valid local dimension
+        if (d == 0)
+            throw exception::DimsInvalid("qpp::Gates::CTRL_sparse()");
+
+        // ctrl + gate subsystem vector
+        std::vector<idx> ctrlgate = ctrl;
+        ctrlgate.insert(std::end(ctrlgate), std::begin(target),
+                        std::end(target));
+        std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+
+        std::vector<idx> dims(n, d); // local dimensions vector
+
+        // check that ctrl + gate subsystem is valid
+        // with respect to local dimensions
+        if (!internal::check_subsys_match_dims(ctrlgate, dims))
+            throw exception::SubsysMismatchDims("qpp::Gates::CTRL_sparse()");
+
+        // check that target list match the dimension of the matrix
+        using Index = typename dyn_mat<typename Derived::Scalar>::Index;
+        if (rA.rows() !=
+            static_cast<Index>(std::llround(std::pow(d, target.size()))))
+            throw exception::DimsMismatchMatrix("qpp::Gates::CTRL_sparse()");
+        // END EXCEPTION CHECKS
+
+        using Scalar = typename Derived::Scalar;
+        using StorageIndex = typename dyn_sparse_mat<Scalar>::StorageIndex;
+        idx n_gate = target.size();
+        idx D = static_cast<idx>(std::llround(std::pow(d, n)));
+        idx DA = static_cast<idx>(rA.rows());
+
+        // the powers A^1, A^2, ..., A^(d-1), A^0 is the identity
+        std::vector<dyn_mat<Scalar>> Ak(d);
+        Ak[0] = dyn_mat<Scalar>::Identity(DA, DA);
+        for (idx k = 1; k < d; ++k)
+            Ak[k] = Ak[k - 1] * rA;
+
+        // offsets of the target block
+        idx Cdims[maxn];
+        idx midx[maxn];
+        for (idx k = 0; k < n; ++k)
+            Cdims[k] = d;
+        std::vector<idx> strides(n);
+        strides[n - 1] = 1;
+        for (idx k = n - 1; k > 0; --k)
+            strides[k - 1] = strides[k] * d;
+        std::vector<idx> offsetsA(DA);
+        for (idx a = 0; a < DA; ++a) {
+            internal::n2multiidx(a, n_gate, Cdims, midx);
+            idx offset = 0;
+            for (idx k = 0; k < n_gate; ++k)
+                offset += midx[k] * strides[target[k]];
+            offsetsA[a] = offset;
+        }
+
+        std::vector<Eigen::Triplet<Scalar, StorageIndex>> triplets;
+        triplets.reserve(D);
+        // run over the rows
+        for (idx r = 0; r < D; ++r) {
+            internal::n2multiidx(r, n, Cdims, midx);
+            // all control subsystems must be in the same state |k>
+            idx k = midx[ctrl[0]];
+            for (idx c = 1; c < ctrl.size() && k != 0; ++c)
+                if (midx[ctrl[c]] != k)
+                    k = 0;
+            if (k == 0) {
+                triplets.emplace_back(static_cast<StorageIndex>(r),
+                                      static_cast<StorageIndex>(r), 1);
+                continue;
+            }
+            // row a of the block A^k, which starts at r - offsetsA[a]
+            idx a = 0;
+            for (idx c = 0; c < n_gate; ++c)
+                a = a * d + midx[target[c]];
+            idx start = r - offsetsA[a];
+            for (idx b = 0; b < DA; ++b)
+                if (Ak[k](a, b) != Scalar{0})
+                    triplets.emplace_back(
+                        static_cast<StorageIndex>(r),
+                        static_cast<StorageIndex>(start + offsetsA[b]),
+                        Ak[k](a, b));
+        }
+
+        dyn_sparse_mat<Scalar> result(D, D);
+        result.setFromTriplets(std::begin(triplets), std::end(triplets));
+
+        return result;
+    }
+
     /**
      * \brief Expands out
      * \see qpp::kron()
@@ -650,6 +830,142 @@ class Gates final : public internal::Singleton<const Gates> // const Singleton
         return this->expandout(A, pos, dims);
     }
 
+    /**
+     * \brief Expands out as a sparse matrix
+     * \see qpp::Gates::expandout(), qpp::apply() for sparse gates
+     *
+     *  Expands out \a A as a sparse matrix in a multi-partite system, only
+     *  the non-zero entries are stored.
+     *
+     * \param A Eigen expression
+     * \param pos Position
+     * \param dims Dimensions of the multi-partite system
+     * \return Tensor product
+     * \f$ I\otimes\cdots\otimes I\otimes A \otimes I \otimes\cdots\otimes I\f$,
+     * with \a A on position \a pos, as a sparse matrix
+     * over the same scalar field as \a A
+     */
+    template <typename Derived>
+    dyn_sparse_mat<typename Derived::Scalar>
+    expandout_sparse(const Eigen::MatrixBase<Derived>& A, idx pos,
+                     const std::vector<idx>& dims) const {
+        const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero-size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::Gates::expandout_sparse()");
+
+        // check that dims is a valid dimension vector
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid("qpp::Gates::expandout_sparse()");
+
+        // check square matrix
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare(
+                "qpp::Gates::expandout_sparse()");
+
+        // check that position is valid
+        if (pos + 1 > dims.size())
+            throw exception::OutOfRange("qpp::Gates::expandout_sparse()");
+
+        // check that dims[pos] match the dimension of A
+        if (static_cast<idx>(rA.rows()) != dims[pos])
+            throw exception::DimsMismatchMatrix(
+                "qpp::Gates::expandout_sparse()");
+        // END EXCEPTION CHECKS
+
+        using Scalar = typename Derived::Scalar;
+        using StorageIndex = typename dyn_sparse_mat<Scalar>::StorageIndex;
+        idx D = std::accumulate(std::begin(dims), std::end(dims),
+                                static_cast<idx>(1), std::multiplies<idx>());
+        idx DA = dims[pos];
+        idx stride = 1;
+        for (idx k = pos + 1; k < dims.size(); ++k)
+            stride *= dims[k];
+
+        // the row r has the digit a = (r / stride) % DA on position pos
+        std::vector<Eigen::Triplet<Scalar, StorageIndex>> triplets;
+        triplets.reserve(D * DA);
+        for (idx r = 0; r < D; ++r) {
+            idx a = (r / stride) % DA;
+            idx start = r - a * stride;
+            for (idx b = 0; b < DA; ++b)
+                if (rA(a, b) != Scalar{0})
+                    triplets.emplace_back(
+                        static_cast<StorageIndex>(r),
+                        static_cast<StorageIndex>(start + b * stride),
+                        rA(a, b));
+        }
+
+        dyn_sparse_mat<Scalar> result(D, D);
+        result.setFromTriplets(std::begin(triplets), std::end(triplets));
+
+        return result;
+    }
+
+    /**
+     * \brief Expands out as a sparse matrix
+     * \see qpp::Gates::expandout(), qpp::apply() for sparse gates
+     *
+     *  Expands out \a A as a sparse matrix in a multi-partite system, only
+     *  the non-zero entries are stored.
+     *
+     * \note The std::initializer_list overload exists for the same reason as
+     * for qpp::Gates::expandout()
+     *
+     * \param A Eigen expression
+     * \param pos Position
+     * \param dims Dimensions of the multi-partite system
+     * \return Tensor product
+     * \f$ I\otimes\cdots\otimes I\otimes A \otimes I \otimes\cdots\otimes I\f$,
+     * with \a A on position \a pos, as a sparse matrix
+     * over the same scalar field as \a A
+     */
+    template <typename Derived>
+    dyn_sparse_mat<typename Derived::Scalar>
+    expandout_sparse(const Eigen::MatrixBase<Derived>& A, idx pos,
+                     const std::initializer_list<idx>& dims) const {
+        return this->expandout_sparse(A, pos, std::vector<idx>(dims));
+    }
+
+    /**
+     * \brief Expands out as a sparse matrix
+     * \see qpp::Gates::expandout(), qpp::apply() for sparse gates
+     *
+     *  Expands out \a A as a sparse matrix in a multi-partite system, only
+     *  the non-zero entries are stored.
+     *
+     * \param A Eigen expression
+     * \param pos Position
+     * \param n Number of subsystems
+     * \param d Subsystem dimensions
+     * \return Tensor product
+     * \f$ I\otimes\cdots\otimes I\otimes A \otimes I \otimes\cdots\otimes I\f$,
+     * with \a A on position \a pos, as a sparse matrix
+     * over the same scalar field as \a A
+     */
+    template <typename Derived>
+    dyn_sparse_mat<typename Derived::Scalar>
+    expandout_sparse(const Eigen::MatrixBase<Derived>& A, idx pos, idx n,
+                     idx d = 2) const {
+        // EXCEPTION CHECKS
+
+        // check zero size
+        if (!internal::check_nonzero_size(A))
+            throw exception::ZeroSize("qpp::Gates::expandout_sparse()");
+
+        // check valid dims
+        if (d == 0)
+            throw exception::DimsInvalid("qpp::Gates::expandout_sparse()");
+        // END EXCEPTION CHECKS
+
+        std::vector<idx> dims(n, d); // local dimensions vector
+
+        return this->expandout_sparse(A, pos, dims);
+    }
+
     // getters
 
     /**
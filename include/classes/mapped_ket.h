@@ -0,0 +1,445 @@
+/*
+ * This file is part of Quantum++.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2013 - 2019 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file classes/mapped_ket.h
+ * \brief State vectors stored in memory-mapped files
+ */
+
+#ifndef CLASSES_MAPPED_KET_H_
+#define CLASSES_MAPPED_KET_H_
+
+#ifdef QPP_HAS_MMAP_
+
+namespace qpp {
+/**
+ * \class qpp::MappedKetT
+ * \brief State vector stored in a memory-mapped file
+ * \see qpp::MappedKet, qpp::MappedKet_f
+ *
+ * The amplitudes live in a file mapped in memory, and are accessed through
+ * an Eigen::Map, from which the class derives. Hence the instance can be
+ * used wherever an Eigen expression is expected, and in particular as the
+ * state of qpp::QEngineT, whose gates are applied directly on the mapping.
+ * The operating system pages the amplitudes in and out, so that the state
+ * may exceed the available memory, and a checkpoint reduces to
+ * qpp::MappedKetT::sync(). Re-opening the file maps the state back, without
+ * reading it.
+ *
+ * The file consists of a 64 bytes header (size and capacity of the state)
+ * followed by the raw amplitudes. Assigning a state that does not fit the
+ * current capacity grows the file; assigning a smaller one (e.g. after a
+ * measurement) does not shrink it.
+ *
+ * \note The copies of an instance are anonymous mappings, not backed by a
+ * file. Available only on POSIX systems.
+ *
+ * Example:
+ * \code
+ * MappedKet psi{"state.bin", 1ULL << 30}; // 30 qubits, all amplitudes zero
+ * psi(0) = 1;
+ * QEngineT<MappedKet> engine{qc, std::move(psi)};
+ * // ... execute some steps, then checkpoint
+ * engine.get_ref_psi().sync();
+ * // after a restart
+ * QEngineT<MappedKet> restarted{qc, MappedKet{"state.bin"}};
+ * \endcode
+ *
+ * \tparam Scalar Scalar field of the state, qpp::cplx or qpp::cplx_f
+ */
+template <typename Scalar>
+class MappedKetT : public Eigen::Map<dyn_col_vect<Scalar>> {
+    using Base = Eigen::Map<dyn_col_vect<Scalar>>; ///< view on the amplitudes
+
+    /**
+     * \brief File header
+     */
+    struct Header {
+        char magic[16];    ///< file signature
+        idx scalar_size;   ///< size in bytes of an amplitude
+        idx size;          ///< number of amplitudes
+        idx capacity;      ///< number of amplitudes stored in the file
+        char reserved[24]; ///< reserved, pads the header to 64 bytes
+    };
+
+    std::string fname_; ///< backing file, empty for an anonymous mapping
+    int fd_;            ///< file descriptor, -1 for an anonymous mapping
+    void* addr_;        ///< start of the mapping, i.e. the header
+    idx capacity_;      ///< number of amplitudes that fit in the mapping
+
+    /**
+     * \brief File signature
+     */
+    static const char* magic_() noexcept { return "QPP::MappedKet"; }
+
+    /**
+     * \brief Size in bytes of a mapping that holds \a capacity amplitudes
+     */
+    static std::size_t bytes_(idx capacity) noexcept {
+        return sizeof(Header) + capacity * sizeof(Scalar);
+    }
+
+    /**
+     * \brief File header, at the start of the mapping
+     */
+    Header* header_() const noexcept { return static_cast<Header*>(addr_); }
+
+    /**
+     * \brief Maps \a capacity amplitudes, of the backing file if any
+     *
+     * \return Start of the mapping
+     */
+    void* map_(idx capacity) const {
+        void* addr =
+            fd_ < 0 ? ::mmap(nullptr, bytes_(capacity), PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+                    : ::mmap(nullptr, bytes_(capacity), PROT_READ | PROT_WRITE,
+                             MAP_SHARED, fd_, 0);
+        if (addr == MAP_FAILED)
+            throw std::runtime_error("qpp::MappedKetT: Error mapping \"" +
+                                     fname_ + "\"!");
+
+        return addr;
+    }
+
+    /**
+     * \brief Unmaps the amplitudes and closes the backing file, if any
+     */
+    void release_() noexcept {
+        if (addr_)
+            ::munmap(addr_, bytes_(capacity_));
+        if (fd_ >= 0)
+            ::close(fd_);
+        addr_ = nullptr;
+        fd_ = -1;
+        capacity_ = 0;
+        new (static_cast<Base*>(this)) Base(nullptr, 0);
+    }
+
+    /**
+     * \brief Grows the mapping so that it holds \a capacity amplitudes,
+     * keeping the current ones
+     */
+    void reserve_(idx capacity) {
+        if (fd_ >= 0) {
+            // the amplitudes are preserved by the file
+            if (::ftruncate(fd_, static_cast<off_t>(bytes_(capacity))) != 0)
+                throw std::runtime_error(
+                    "qpp::MappedKetT: Error writing output file \"" + fname_ +
+                    "\"!");
+            void* addr = map_(capacity);
+            ::munmap(addr_, bytes_(capacity_));
+            addr_ = addr;
+        } else {
+            void* addr = map_(capacity);
+            std::memcpy(addr, addr_, bytes_(capacity_));
+            ::munmap(addr_, bytes_(capacity_));
+            addr_ = addr;
+        }
+        capacity_ = capacity;
+        header_()->capacity = capacity;
+    }
+
+    /**
+     * \brief Points the Eigen::Map base to the first \a D amplitudes
+     */
+    void rebind_(idx D) noexcept {
+        header_()->size = D;
+        // re-seating an Eigen::Map, see the Eigen documentation of Map
+        new (static_cast<Base*>(this))
+            Base(reinterpret_cast<Scalar*>(static_cast<char*>(addr_) +
+                                           sizeof(Header)),
+                 static_cast<Eigen::Index>(D));
+    }
+
+    /**
+     * \brief Anonymous mapping of \a D amplitudes
+     */
+    void init_anonymous_(idx D) {
+        addr_ = map_(D);
+        capacity_ = D;
+        std::memcpy(header_()->magic, magic_(), std::strlen(magic_()));
+        header_()->scalar_size = sizeof(Scalar);
+        header_()->capacity = D;
+        rebind_(D);
+    }
+
+  public:
+    /**
+     * \brief Creates the file \a fname, or truncates it if it exists, and
+     * maps a state vector of \a D amplitudes, all zero
+     *
+     * \param fname Backing file name
+     * \param D Number of amplitudes
+     */
+    MappedKetT(const std::string& fname, idx D)
+        : Base{nullptr, 0}, fname_{fname}, fd_{-1}, addr_{nullptr},
+          capacity_{0} {
+        // EXCEPTION CHECKS
+
+        if (D == 0)
+            throw exception::ZeroSize("qpp::MappedKetT::MappedKetT()");
+        fd_ = ::open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0)
+            throw std::runtime_error(
+                "qpp::MappedKetT::MappedKetT(): Error writing output file \"" +
+                fname + "\"!");
+        // END EXCEPTION CHECKS
+
+        // the file is extended with zeros
+        if (::ftruncate(fd_, static_cast<off_t>(bytes_(D))) != 0) {
+            release_();
+            throw std::runtime_error(
+                "qpp::MappedKetT::MappedKetT(): Error writing output file \"" +
+                fname + "\"!");
+        }
+        try {
+            addr_ = map_(D);
+        } catch (...) {
+            release_();
+            throw;
+        }
+        capacity_ = D;
+        std::memcpy(header_()->magic, magic_(), std::strlen(magic_()));
+        header_()->scalar_size = sizeof(Scalar);
+        header_()->capacity = D;
+        rebind_(D);
+    }
+
+    /**
+     * \brief Maps the state vector stored in the existing file \a fname,
+     * e.g. to restart from a checkpoint
+     *
+     * \param fname Backing file name
+     */
+    explicit MappedKetT(const std::string& fname)
+        : Base{nullptr, 0}, fname_{fname}, fd_{-1}, addr_{nullptr},
+          capacity_{0} {
+        // EXCEPTION CHECKS
+
+        fd_ = ::open(fname.c_str(), O_RDWR);
+        if (fd_ < 0)
+            throw std::runtime_error(
+                "qpp::MappedKetT::MappedKetT(): Error opening input file \"" +
+                fname + "\"!");
+
+        // the header is validated before the amplitudes are mapped
+        Header header;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(Header) ||
+            ::pread(fd_, &header, sizeof(Header), 0) !=
+                static_cast<ssize_t>(sizeof(Header)) ||
+            std::strncmp(header.magic, magic_(), std::strlen(magic_())) != 0 ||
+            header.scalar_size != sizeof(Scalar) ||
+            header.size == 0 || header.size > header.capacity ||
+            // no multiplication, a corrupted capacity could overflow it
+            header.capacity > (static_cast<std::size_t>(st.st_size) -
+                               sizeof(Header)) /
+                                  sizeof(Scalar)) {
+            release_();
+            throw std::runtime_error("qpp::MappedKetT::MappedKetT(): Input "
+                                     "file \"" +
+                                     fname + "\" is corrupted!");
+        }
+        // END EXCEPTION CHECKS
+
+        try {
+            addr_ = map_(header.capacity);
+        } catch (...) {
+            release_();
+            throw;
+        }
+        capacity_ = header.capacity;
+        rebind_(header.size);
+    }
+
+    /**
+     * \brief Anonymous mapping (not backed by a file) initialized with the
+     * column vector \a A
+     *
+     * \param A Eigen expression
+     */
+    template <typename Derived>
+    explicit MappedKetT(const Eigen::MatrixBase<Derived>& A)
+        : Base{nullptr, 0}, fname_{}, fd_{-1}, addr_{nullptr}, capacity_{0} {
+        // EXCEPTION CHECKS
+
+        if (!internal::check_cvector(A))
+            throw exception::MatrixNotCvector("qpp::MappedKetT::MappedKetT()");
+        // END EXCEPTION CHECKS
+
+        init_anonymous_(static_cast<idx>(A.size()));
+        Base::operator=(A.template cast<Scalar>());
+    }
+
+    /**
+     * \brief Copy constructor, the copy is an anonymous mapping (not backed
+     * by a file)
+     *
+     * \param other Instance to be copied
+     */
+    MappedKetT(const MappedKetT& other)
+        : Base{nullptr, 0}, fname_{}, fd_{-1}, addr_{nullptr}, capacity_{0} {
+        init_anonymous_(static_cast<idx>(other.size()));
+        Base::operator=(other);
+    }
+
+    /**
+     * \brief Move constructor, takes over the mapping of \a other
+     *
+     * \param other Instance to be moved, left empty
+     */
+    MappedKetT(MappedKetT&& other) noexcept
+        : Base{nullptr, 0}, fname_{std::move(other.fname_)}, fd_{other.fd_},
+          addr_{other.addr_}, capacity_{other.capacity_} {
+        idx D = static_cast<idx>(other.size());
+        other.addr_ = nullptr;
+        other.fd_ = -1;
+        other.release_();
+        if (addr_)
+            rebind_(D);
+    }
+
+    /**
+     * \brief Copies the amplitudes of \a other, the backing file (if any)
+     * is kept
+     *
+     * \param other Instance to be copied
+     * \return Reference to the current instance
+     */
+    MappedKetT& operator=(const MappedKetT& other) {
+        if (this != &other)
+            *this = static_cast<const Base&>(other);
+
+        return *this;
+    }
+
+    /**
+     * \brief Move assignment, takes over the mapping of \a other
+     *
+     * \param other Instance to be moved, left empty
+     * \return Reference to the current instance
+     */
+    MappedKetT& operator=(MappedKetT&& other) noexcept {
+        if (this != &other) {
+            release_();
+            idx D = static_cast<idx>(other.size());
+            fname_ = std::move(other.fname_);
+            fd_ = other.fd_;
+            addr_ = other.addr_;
+            capacity_ = other.capacity_;
+            other.addr_ = nullptr;
+            other.fd_ = -1;
+            other.release_();
+            if (addr_)
+                rebind_(D);
+        }
+
+        return *this;
+    }
+
+    /**
+     * \brief Copies the column vector \a A, growing the mapping (and the
+     * backing file) if needed
+     *
+     * \param A Eigen expression
+     * \return Reference to the current instance
+     */
+    template <typename Derived>
+    MappedKetT& operator=(const Eigen::MatrixBase<Derived>& A) {
+        // EXCEPTION CHECKS
+
+        if (!internal::check_cvector(A))
+            throw exception::MatrixNotCvector("qpp::MappedKetT::operator=()");
+        // END EXCEPTION CHECKS
+
+        idx D = static_cast<idx>(A.size());
+        if (!addr_) {
+            init_anonymous_(D);
+            Base::operator=(A.template cast<Scalar>());
+        } else if (D > capacity_) {
+            // A may refer to the current mapping, which is about to move
+            dyn_col_vect<Scalar> tmp = A.template cast<Scalar>();
+            reserve_(D);
+            rebind_(D);
+            Base::operator=(tmp);
+        } else {
+            rebind_(D);
+            Base::operator=(A.template cast<Scalar>());
+        }
+
+        return *this;
+    }
+
+    /**
+     * \brief Unmaps the state vector, see qpp::MappedKetT::sync()
+     */
+    ~MappedKetT() { release_(); }
+
+    /**
+     * \brief Flushes the amplitudes to the backing file (checkpoint), no-op
+     * for anonymous mappings
+     */
+    void sync() const {
+        if (fd_ >= 0 && ::msync(addr_, bytes_(capacity_), MS_SYNC) != 0)
+            throw std::runtime_error(
+                "qpp::MappedKetT::sync(): Error writing output file \"" +
+                fname_ + "\"!");
+    }
+
+    /**
+     * \brief Backing file name
+     *
+     * \return Backing file name, empty for anonymous mappings
+     */
+    std::string get_fname() const { return fname_; }
+
+    /**
+     * \brief Capacity
+     *
+     * \return Number of amplitudes that fit in the mapping
+     */
+    idx get_capacity() const noexcept { return capacity_; }
+}; /* class MappedKetT */
+
+/**
+ * \brief Double precision state vector stored in a memory-mapped file
+ * \see qpp::MappedKetT
+ */
+using MappedKet = MappedKetT<cplx>;
+
+/**
+ * \brief Single precision state vector stored in a memory-mapped file
+ * \see qpp::MappedKetT
+ */
+using MappedKet_f = MappedKetT<cplx_f>;
+
+} /* namespace qpp */
+
+#endif /* QPP_HAS_MMAP_ */
+
+#endif /* CLASSES_MAPPED_KET_H_ */
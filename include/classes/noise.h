@@ -90,13 +90,12 @@ class NoiseBase {
             throw exception::ZeroSize("qpp::Noise::compute_probs_()");
         // END EXCEPTION CHECKS
 
-        cmat rho_i;
         idx n = internal::get_num_subsys(state.rows(), d_);
+        // the reduced state does not depend on the noise element
+        cmat rho_i = ptrace(state, complement(target, n), d_);
 
-        for (idx i = 0; i < Ks_.size(); ++i) {
-            rho_i = ptrace(state, complement(target, n), d_);
+        for (idx i = 0; i < Ks_.size(); ++i)
             probs_[i] = trace(Ks_[i] * rho_i * adjoint(Ks_[i])).real();
-        }
     } /* compute_probs_() */
 
     /**
@@ -287,6 +286,87 @@ class NoiseBase {
     }
     // end getters
 
+    /**
+     * \brief Quantum trajectory step, applies in place one randomly chosen
+     * noise element on the part \a target of the multi-partite state vector
+     * \a psi, then renormalizes \a psi
+     *
+     * For StateDependent noise the probability of each noise element is the
+     * squared norm of the corresponding branch, all branch norms being
+     * computed from the reduced state of \a target in a single pass over
+     * \a psi. The identity noise elements are not applied.
+     *
+     * \note Does not modify the internal state of the noise instance, hence
+     * the same instance can be shared by trajectories running in parallel;
+     * the getters qpp::NoiseBase::get_last_idx() etc. are not updated
+     *
+     * \param psi Multi-partite state vector, modified in place, either in
+     * double (qpp::ket) or in single (qpp::ket_f) precision
+     * \param target Subsystem indexes where the noise is applied
+     * \param dims Dimensions of the multi-partite system
+     * \return Index of the noise element that occurred
+     */
+    template <typename Derived>
+    idx apply_trajectory(Eigen::MatrixBase<Derived>& psi,
+                         const std::vector<idx>& target,
+                         const std::vector<idx>& dims) const {
+        using Scalar = typename Derived::Scalar;
+
+        // minimal EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(psi))
+            throw exception::ZeroSize("qpp::Noise::apply_trajectory()");
+        if (!internal::check_dims_match_cvect(dims, psi))
+            throw exception::DimsMismatchCvector(
+                "qpp::Noise::apply_trajectory()");
+        if (!internal::check_subsys_match_dims(target, dims))
+            throw exception::SubsysMismatchDims(
+                "qpp::Noise::apply_trajectory()");
+        idx DA = 1;
+        for (auto&& elem : target)
+            DA *= dims[elem];
+        if (DA != static_cast<idx>(Ks_[0].rows()))
+            throw exception::DimsMismatchMatrix(
+                "qpp::Noise::apply_trajectory()");
+        // END EXCEPTION CHECKS
+
+        std::vector<double> probs = probs_;
+        double norm2 = 1; // squared norm of psi
+        if (std::is_same<NoiseType::StateDependent, noise_type>::value) {
+            // the probabilities are computed in double precision
+            cmat rho_target = internal::reduced_rho_ket(psi, target, dims)
+                                  .template cast<cplx>();
+            norm2 = std::real(rho_target.trace());
+            for (idx i = 0; i < Ks_.size(); ++i)
+                probs[i] =
+                    std::real((Ks_[i] * rho_target * adjoint(Ks_[i])).trace());
+        }
+
+        std::discrete_distribution<idx> dd{std::begin(probs),
+                                           std::end(probs)};
+        auto& gen =
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+        idx i = dd(gen);
+        if (Ks_[i].isIdentity())
+            return i;
+
+        internal::apply_ctrl_ket_inplace(
+            psi, dyn_mat<Scalar>(Ks_[i].template cast<Scalar>()), {}, target,
+            dims);
+        // the squared norm of the branch is known for StateDependent noise
+        if (std::is_same<NoiseType::StateDependent, noise_type>::value)
+            psi /= static_cast<typename Derived::RealScalar>(
+                std::sqrt(probs[i] / norm2));
+        else
+            internal::renormalize_ket(psi);
+
+        return i;
+    }
+
     /**
      * \brief Function invocation operator, applies the underlying noise
      * model on qudit \a target of the multi-partite state vector or density
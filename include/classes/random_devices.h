@@ -33,6 +33,127 @@
 #define CLASSES_RANDOM_DEVICES_H_
 
 namespace qpp {
+/**
+ * \class qpp::Philox4x32
+ * \brief Counter-based random number generator Philox-4x32-10
+ *
+ * Maps a 128-bit counter and a 64-bit key to 128 random bits, see J. K.
+ * Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11. As the
+ * output depends only on the counter, the elements of a matrix can be
+ * generated independently, by any number of threads, and yet reproducibly.
+ *
+ * \see qpp::RandomDevices::get_counter_based_prng()
+ */
+class Philox4x32 {
+    std::uint32_t key_[2]; ///< key
+
+  public:
+    /**
+     * \brief Constructs the generator
+     *
+     * \param key Key (seed)
+     */
+    explicit Philox4x32(std::uint64_t key) noexcept
+        : key_{static_cast<std::uint32_t>(key),
+               static_cast<std::uint32_t>(key >> 32)} {}
+
+    /**
+     * \brief Random bits of a counter
+     *
+     * \param counter Low 64 bits of the counter
+     * \param out Output, 4 random 32-bit words
+     * \param stream High 64 bits of the counter
+     */
+    void operator()(std::uint64_t counter, std::uint32_t* out,
+                    std::uint64_t stream = 0) const noexcept {
+        std::uint32_t c[4] = {static_cast<std::uint32_t>(counter),
+                              static_cast<std::uint32_t>(counter >> 32),
+                              static_cast<std::uint32_t>(stream),
+                              static_cast<std::uint32_t>(stream >> 32)};
+        std::uint32_t k0 = key_[0], k1 = key_[1];
+        for (idx round = 0; round < 10; ++round) {
+            std::uint64_t p0 = std::uint64_t{0xD2511F53u} * c[0];
+            std::uint64_t p1 = std::uint64_t{0xCD9E8D57u} * c[2];
+            std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+            std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+            c[1] = static_cast<std::uint32_t>(p1);
+            c[3] = static_cast<std::uint32_t>(p0);
+            c[0] = n0;
+            c[2] = n2;
+            // Weyl sequence of the key
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        for (idx i = 0; i < 4; ++i)
+            out[i] = c[i];
+    }
+
+    /**
+     * \brief Fills \a n doubles with random numbers uniformly distributed in
+     * [a, b), the element \a i being generated from the counter \a i / 2,
+     * in parallel for large \a n
+     *
+     * \param p Output
+     * \param n Number of elements
+     * \param a Beginning of the interval, belongs to it
+     * \param b End of the interval, does not belong to it
+     */
+    void fill_uniform(double* p, idx n, double a, double b) const noexcept {
+        idx nblocks = (n + 1) / 2;
+#ifdef WITH_OPENMP_
+#pragma omp parallel for if (nblocks > 4096)
+#endif // WITH_OPENMP_
+        for (idx k = 0; k < nblocks; ++k) {
+            std::uint32_t r[4];
+            (*this)(k, r);
+            for (idx i = 0; i < 2 && 2 * k + i < n; ++i) {
+                double x = a + (b - a) * unit_(r[2 * i], r[2 * i + 1]);
+                // guard against the rounding up to b
+                p[2 * k + i] = x < b ? x : std::nextafter(b, a);
+            }
+        }
+    }
+
+    /**
+     * \brief Fills \a n doubles with random numbers normally distributed in
+     * N(mean, sigma) (Box-Muller), the elements \a i and \a i + 1, \a i
+     * even, being generated from the counter \a i / 2, in parallel for large
+     * \a n
+     *
+     * \param p Output
+     * \param n Number of elements
+     * \param mean Mean
+     * \param sigma Standard deviation
+     */
+    void fill_normal(double* p, idx n, double mean, double sigma) const {
+        idx nblocks = (n + 1) / 2;
+#ifdef WITH_OPENMP_
+#pragma omp parallel for if (nblocks > 4096)
+#endif // WITH_OPENMP_
+        for (idx k = 0; k < nblocks; ++k) {
+            std::uint32_t r[4];
+            (*this)(k, r);
+            // u1 in (0, 1], so that its logarithm is finite
+            double u1 = 1 - unit_(r[0], r[1]);
+            double u2 = unit_(r[2], r[3]);
+            double rho = sigma * std::sqrt(-2 * std::log(u1));
+            double theta = 2 * pi * u2;
+            p[2 * k] = mean + rho * std::cos(theta);
+            if (2 * k + 1 < n)
+                p[2 * k + 1] = mean + rho * std::sin(theta);
+        }
+    }
+
+  private:
+    /**
+     * \brief Uniform double in [0, 1), out of two 32-bit words
+     */
+    static double unit_(std::uint32_t hi, std::uint32_t lo) noexcept {
+        std::uint64_t x = (static_cast<std::uint64_t>(hi) << 32) | lo;
+        return static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0);
+    }
+}; /* class Philox4x32 */
+
 /**
  * \class qpp::RandomDevices
  * \brief Singleton class that manages the source of randomness in the library
@@ -41,6 +162,12 @@ namespace qpp {
  * random number generator engine and an std::random_device engine. The latter
  * is used to seed the Mersenne twister.
  *
+ * The random matrices are generated by a qpp::Philox4x32 counter-based
+ * generator, keyed by the Mersenne twister, see
+ * qpp::RandomDevices::get_counter_based_prng(). Hence they are reproducible
+ * from the seed of the Mersenne twister, whatever the number of threads
+ * that generate them.
+ *
  * \warning This class DOES NOT seed the standard C number generator used by
  * Eigen::Matrix::Random(), since it is not thread safe. Do not use
  * Eigen::Matrix::Random() or functions that depend on the C style random
@@ -60,6 +187,21 @@ class RandomDevices final : public internal::Singleton<RandomDevices> //
      */
     std::mt19937& get_prng() { return prng_; }
 
+    /**
+     * \brief Returns a counter-based PRNG, keyed by two draws of the
+     * internal PRNG
+     *
+     * Each call returns a generator with a new key, used to fill one
+     * matrix in parallel.
+     *
+     * \return Counter-based PRNG
+     */
+    Philox4x32 get_counter_based_prng() {
+        std::uint64_t hi = prng_();
+        std::uint64_t lo = prng_();
+        return Philox4x32{(hi << 32) | lo};
+    }
+
     /**
      * \brief Loads the state of the PRNG from an input stream
      * \param is Input stream
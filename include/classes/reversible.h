@@ -111,11 +111,14 @@ class Dynamic_bitset : public IDisplay {
      */
     idx count() const noexcept {
         idx result = 0;
-        idx bitset_size = this->size();
-        for (idx i = 0; i < bitset_size; ++i) {
-            if (this->get(i))
-                ++result;
-        }
+        idx nwords = N_ / (sizeof(value_type) * CHAR_BIT);
+        for (idx i = 0; i < nwords; ++i)
+            result += internal::popcount(v_[i]);
+        // the bits past the end of the bitset are not counted
+        idx rem = offset_(N_);
+        if (rem)
+            result += internal::popcount(v_[nwords] &
+                                         ((value_type{1} << rem) - 1));
 
         return result;
     }
@@ -326,11 +329,14 @@ class Dynamic_bitset : public IDisplay {
      */
     idx operator-(const Dynamic_bitset& rhs) const noexcept {
         idx result = 0;
-        idx bitset_size = this->size();
-        for (idx i = 0; i < bitset_size; ++i) {
-            if (this->get(i) != rhs.get(i))
-                ++result;
-        }
+        idx nwords = N_ / (sizeof(value_type) * CHAR_BIT);
+        for (idx i = 0; i < nwords; ++i)
+            result += internal::popcount(v_[i] ^ rhs.v_[i]);
+        // the bits past the end of the bitsets are not counted
+        idx rem = offset_(N_);
+        if (rem)
+            result += internal::popcount((v_[nwords] ^ rhs.v_[nwords]) &
+                                         ((value_type{1} << rem) - 1));
 
         return result;
     }
@@ -447,17 +453,45 @@ class Bit_circuit : public Dynamic_bitset {
     /**
      * \brief Controlled-NOT
      *
-     * \param pos Bit position in the circuit
+     * \param ctrl Control bit position in the circuit
+     * \param target Target bit position in the circuit
      * \return Reference to the current instance
      */
-    Bit_circuit& CNOT(const std::vector<idx>& pos) {
-        v_[index_(pos[1])] ^= (1 & (v_[index_(pos[0])] >> offset_(pos[0])))
-                              << offset_(pos[1]);
+    Bit_circuit& CNOT(idx ctrl, idx target) {
+        v_[index_(target)] ^= (1 & (v_[index_(ctrl)] >> offset_(ctrl)))
+                              << offset_(target);
         ++gate_count.CNOT;
 
         return *this;
     }
 
+    /**
+     * \brief Controlled-NOT
+     *
+     * \param pos Bit positions in the circuit, in the order control-target
+     * \return Reference to the current instance
+     */
+    Bit_circuit& CNOT(const std::vector<idx>& pos) {
+        return CNOT(pos[0], pos[1]);
+    }
+
+    /**
+     * \brief Toffoli gate
+     *
+     * \param ctrl1 First control bit position in the circuit
+     * \param ctrl2 Second control bit position in the circuit
+     * \param target Target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Bit_circuit& TOF(idx ctrl1, idx ctrl2, idx target) {
+        v_[index_(target)] ^= ((1 & (v_[index_(ctrl2)] >> offset_(ctrl2))) &
+                               (1 & (v_[index_(ctrl1)] >> offset_(ctrl1))))
+                              << offset_(target);
+        ++gate_count.TOF;
+
+        return *this;
+    }
+
     /**
      * \brief Toffoli gate
      *
@@ -466,10 +500,22 @@ class Bit_circuit : public Dynamic_bitset {
      * \return Reference to the current instance
      */
     Bit_circuit& TOF(const std::vector<idx>& pos) {
-        v_[index_(pos[2])] ^= ((1 & (v_[index_(pos[1])] >> offset_(pos[1]))) &
-                               (1 & (v_[index_(pos[0])] >> offset_(pos[0]))))
-                              << offset_(pos[2]);
-        ++gate_count.TOF;
+        return TOF(pos[0], pos[1], pos[2]);
+    }
+
+    /**
+     * \brief Swap bits
+     *
+     * \param pos1 First bit position in the circuit
+     * \param pos2 Second bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Bit_circuit& SWAP(idx pos1, idx pos2) {
+        if (this->get(pos1) != this->get(pos2)) {
+            this->flip(pos1);
+            this->flip(pos2);
+        }
+        ++gate_count.SWAP;
 
         return *this;
     }
@@ -481,11 +527,23 @@ class Bit_circuit : public Dynamic_bitset {
      * \return Reference to the current instance
      */
     Bit_circuit& SWAP(const std::vector<idx>& pos) {
-        if (this->get(pos[0]) != this->get(pos[1])) {
-            this->X(pos[0]);
-            this->X(pos[1]);
+        return SWAP(pos[0], pos[1]);
+    }
+
+    /**
+     * \brief Fredkin gate (Controlled-SWAP)
+     *
+     * \param ctrl Control bit position in the circuit
+     * \param target1 First target bit position in the circuit
+     * \param target2 Second target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Bit_circuit& FRED(idx ctrl, idx target1, idx target2) {
+        if (this->get(ctrl) && this->get(target1) != this->get(target2)) {
+            this->flip(target1);
+            this->flip(target2);
         }
-        ++gate_count.SWAP;
+        ++gate_count.FRED;
 
         return *this;
     }
@@ -498,12 +556,7 @@ class Bit_circuit : public Dynamic_bitset {
      * \return Reference to the current instance
      */
     Bit_circuit& FRED(const std::vector<idx>& pos) {
-        if (this->get(pos[0])) {
-            this->SWAP({pos[1], pos[2]});
-        }
-        ++gate_count.FRED;
-
-        return *this;
+        return FRED(pos[0], pos[1], pos[2]);
     }
 
     /**
@@ -521,6 +574,763 @@ class Bit_circuit : public Dynamic_bitset {
     }
 }; /* class Bit_circuit */
 
+/**
+ * \class qpp::Sliced_bit_circuit
+ * \brief Bit-sliced classical reversible circuit simulator, evaluates the
+ * same gates on 64 * \a W inputs at once
+ * \see qpp::Bit_circuit
+ *
+ * Each bit of the circuit is stored as \a W 64-bit words, and the bit \a j
+ * of this storage holds the value of the bit on the input \a j. A gate is
+ * then a few bitwise operations on \a W words, which the compiler
+ * vectorizes when \a W is 4 (AVX2) or 8 (AVX-512), i.e. 256, respectively
+ * 512, inputs per gate.
+ *
+ * Example, exhaustive check of an oracle on n input bits:
+ * \code
+ * Sliced_bit_circuit<4> bc{N};
+ * for (idx first = 0; first < (1ULL << n); first += bc.batch_size()) {
+ *     bc.reset().set_range(first, 0, n);
+ *     bc.TOF(0, 1, n).CNOT(2, n); // ... the gates of the oracle
+ *     for (idx j = 0; j < bc.batch_size(); ++j)
+ *         assert(bc.get_value(j, n, 1) == f(first + j));
+ * }
+ * \endcode
+ *
+ * \tparam W Number of 64-bit words per bit, the batch size is 64 * \a W
+ */
+template <idx W = 1>
+class Sliced_bit_circuit : public IDisplay {
+  public:
+    using value_type = std::uint64_t; ///< Type of the storage elements
+
+  protected:
+    idx N_;                     ///< Number of bits
+    std::vector<value_type> v_; ///< Storage space, W words per bit
+
+    /**
+     * \brief Words of the bit at position \a pos
+     *
+     * \param pos Bit position in the circuit
+     * \return Pointer to the first word of the bit at position \a pos
+     */
+    value_type* words_(idx pos) noexcept { return v_.data() + pos * W; }
+
+    /**
+     * \brief Words of the bit at position \a pos
+     *
+     * \param pos Bit position in the circuit
+     * \return Pointer to the first word of the bit at position \a pos
+     */
+    const value_type* words_(idx pos) const noexcept {
+        return v_.data() + pos * W;
+    }
+
+  public:
+    /**
+     * \brief Constructor, initializes all bits of all inputs to false (zero)
+     *
+     * \param N Number of bits in the circuit
+     */
+    explicit Sliced_bit_circuit(idx N) : N_{N}, v_(N * W) {}
+
+    /**
+     * \brief Number of inputs evaluated at once
+     *
+     * \return Batch size, 64 * W
+     */
+    static constexpr idx batch_size() noexcept { return 64 * W; }
+
+    /**
+     * \brief Number of bits in the circuit
+     *
+     * \return Number of bits in the circuit
+     */
+    idx size() const noexcept { return N_; }
+
+    /**
+     * \brief The value of the bit at position \a pos on the input \a j
+     *
+     * \param pos Bit position in the circuit
+     * \param j Input index, less than qpp::Sliced_bit_circuit::batch_size()
+     * \return The value of the bit at position \a pos on the input \a j
+     */
+    bool get(idx pos, idx j) const noexcept {
+        return 1 & (words_(pos)[j / 64] >> (j % 64));
+    }
+
+    /**
+     * \brief The integer stored on \a n consecutive bits on the input \a j
+     *
+     * \param j Input index, less than qpp::Sliced_bit_circuit::batch_size()
+     * \param pos Position of the least significant bit
+     * \param n Number of bits, at most 64
+     * \return The integer whose bit \a k is the bit at position
+     * \a pos + \a k on the input \a j
+     */
+    idx get_value(idx j, idx pos, idx n) const noexcept {
+        idx result = 0;
+        for (idx k = 0; k < n; ++k)
+            result |= static_cast<idx>(get(pos + k, j)) << k;
+
+        return result;
+    }
+
+    /**
+     * \brief The bits of the input \a j
+     *
+     * \param j Input index, less than qpp::Sliced_bit_circuit::batch_size()
+     * \return The bits of the input \a j
+     */
+    Dynamic_bitset get_input(idx j) const {
+        Dynamic_bitset result{N_};
+        for (idx pos = 0; pos < N_; ++pos)
+            result.set(pos, get(pos, j));
+
+        return result;
+    }
+
+    /**
+     * \brief Sets the bit at position \a pos on the input \a j
+     *
+     * \param pos Bit position in the circuit
+     * \param j Input index, less than qpp::Sliced_bit_circuit::batch_size()
+     * \param value Bit value
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& set(idx pos, idx j, bool value = true) noexcept {
+        value_type mask = value_type{1} << (j % 64);
+        value ? words_(pos)[j / 64] |= mask : words_(pos)[j / 64] &= ~mask;
+
+        return *this;
+    }
+
+    /**
+     * \brief Sets the bits of the input \a j
+     *
+     * \param j Input index, less than qpp::Sliced_bit_circuit::batch_size()
+     * \param bits Bits of the input, of the same size as the circuit
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& set_input(idx j, const Dynamic_bitset& bits) {
+        for (idx pos = 0; pos < N_; ++pos)
+            set(pos, j, bits.get(pos));
+
+        return *this;
+    }
+
+    /**
+     * \brief Sets the \a n consecutive bits starting at \a pos to the
+     * integers \a first, \a first + 1, ..., one per input
+     *
+     * Intended for the exhaustive enumeration of the inputs, batch by batch.
+     *
+     * \param first Integer of the input 0
+     * \param pos Position of the least significant bit
+     * \param n Number of bits, at most 64
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& set_range(idx first, idx pos, idx n) noexcept {
+        for (idx w = 0; w < W; ++w) {
+            for (idx k = 0; k < n; ++k) {
+                value_type word = 0;
+                for (idx b = 0; b < 64; ++b)
+                    word |= static_cast<value_type>(
+                                ((first + w * 64 + b) >> k) & 1)
+                            << b;
+                words_(pos + k)[w] = word;
+            }
+        }
+
+        return *this;
+    }
+
+    /**
+     * \brief Sets all bits of all inputs to false
+     *
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& reset() noexcept {
+        std::fill(std::begin(v_), std::end(v_), 0);
+
+        return *this;
+    }
+
+    /* gates, applied to all inputs */
+    /**
+     * \brief Bit flip
+     *
+     * \param pos Bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& X(idx pos) noexcept {
+        value_type* t = words_(pos);
+        for (idx w = 0; w < W; ++w)
+            t[w] = ~t[w];
+
+        return *this;
+    }
+
+    /**
+     * \brief Bit flip
+     *
+     * \param pos Bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& NOT(idx pos) noexcept { return X(pos); }
+
+    /**
+     * \brief Controlled-NOT
+     *
+     * \param ctrl Control bit position in the circuit
+     * \param target Target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& CNOT(idx ctrl, idx target) noexcept {
+        const value_type* c = words_(ctrl);
+        value_type* t = words_(target);
+        for (idx w = 0; w < W; ++w)
+            t[w] ^= c[w];
+
+        return *this;
+    }
+
+    /**
+     * \brief Toffoli gate
+     *
+     * \param ctrl1 First control bit position in the circuit
+     * \param ctrl2 Second control bit position in the circuit
+     * \param target Target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& TOF(idx ctrl1, idx ctrl2, idx target) noexcept {
+        const value_type* c1 = words_(ctrl1);
+        const value_type* c2 = words_(ctrl2);
+        value_type* t = words_(target);
+        for (idx w = 0; w < W; ++w)
+            t[w] ^= c1[w] & c2[w];
+
+        return *this;
+    }
+
+    /**
+     * \brief Swap bits
+     *
+     * \param pos1 First bit position in the circuit
+     * \param pos2 Second bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& SWAP(idx pos1, idx pos2) noexcept {
+        value_type* a = words_(pos1);
+        value_type* b = words_(pos2);
+        for (idx w = 0; w < W; ++w)
+            std::swap(a[w], b[w]);
+
+        return *this;
+    }
+
+    /**
+     * \brief Fredkin gate (Controlled-SWAP)
+     *
+     * \param ctrl Control bit position in the circuit
+     * \param target1 First target bit position in the circuit
+     * \param target2 Second target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Sliced_bit_circuit& FRED(idx ctrl, idx target1, idx target2) noexcept {
+        const value_type* c = words_(ctrl);
+        value_type* a = words_(target1);
+        value_type* b = words_(target2);
+        for (idx w = 0; w < W; ++w) {
+            value_type m = c[w] & (a[w] ^ b[w]);
+            a[w] ^= m;
+            b[w] ^= m;
+        }
+
+        return *this;
+    }
+
+  private:
+    /**
+     * \brief qpp::IDisplay::display() override, displays the bits of each
+     * input, one input per line
+     *
+     * \param os Output stream passed by reference
+     * \return Reference to the output stream
+     */
+    std::ostream& display(std::ostream& os) const override {
+        for (idx j = 0; j < batch_size(); ++j) {
+            for (idx pos = N_; pos-- > 0;)
+                os << get(pos, j);
+            if (j + 1 < batch_size())
+                os << '\n';
+        }
+
+        return os;
+    }
+}; /* class Sliced_bit_circuit */
+
+/**
+ * \class qpp::Compiled_bit_circuit
+ * \brief Classical reversible circuit stored as a list of gates, built once
+ * and then executed on many inputs
+ * \see qpp::Bit_circuit, qpp::Sliced_bit_circuit
+ *
+ * The gates are recorded with the same interface as qpp::Bit_circuit, and
+ * executed with qpp::Compiled_bit_circuit::apply() on a qpp::Bit_circuit or
+ * on a qpp::Sliced_bit_circuit, or with qpp::Compiled_bit_circuit::run() on
+ * many inputs in parallel.
+ *
+ * Example:
+ * \code
+ * Compiled_bit_circuit oracle{3};
+ * oracle.TOF(0, 1, 2).CNOT(0, 1);
+ * Bit_circuit bc{3};
+ * bc.X(0).X(1);
+ * oracle.apply(bc); // bc is now 101
+ * oracle.inverse().apply(bc); // back to 011
+ * \endcode
+ */
+class Compiled_bit_circuit : public IDisplay {
+  public:
+    /**
+     * \brief Type of gate
+     */
+    enum class Gate_type {
+        NOT,  ///< bit flip, acts on pos[0]
+        CNOT, ///< controlled-NOT, control pos[0], target pos[1]
+        SWAP, ///< swap of pos[0] and pos[1]
+        FRED, ///< Fredkin, control pos[0], targets pos[1] and pos[2]
+        TOF,  ///< Toffoli, controls pos[0] and pos[1], target pos[2]
+    };
+
+    /**
+     * \brief One gate of the circuit
+     */
+    struct Gate {
+        Gate_type type; ///< type of gate
+        idx pos[3];     ///< bit positions, see qpp::Compiled_bit_circuit::
+                        ///< Gate_type, the unused ones are ignored
+
+        /**
+         * \brief Number of bits the gate acts on
+         *
+         * \return Number of bits
+         */
+        idx size() const noexcept {
+            return type == Gate_type::NOT
+                       ? 1
+                       : (type == Gate_type::CNOT ||
+                          type == Gate_type::SWAP)
+                             ? 2
+                             : 3;
+        }
+
+        /**
+         * \brief Equality operator, up to the order of the bits that play
+         * the same role (the controls of TOF, the targets of SWAP and FRED)
+         *
+         * \param rhs Gate against which the equality is being tested
+         * \return True if the gates are the same
+         */
+        bool operator==(const Gate& rhs) const noexcept {
+            if (type != rhs.type)
+                return false;
+            auto same = [&](idx i, idx j) {
+                return (pos[i] == rhs.pos[i] && pos[j] == rhs.pos[j]) ||
+                       (pos[i] == rhs.pos[j] && pos[j] == rhs.pos[i]);
+            };
+            switch (type) {
+            case Gate_type::NOT:
+                return pos[0] == rhs.pos[0];
+            case Gate_type::CNOT:
+                return pos[0] == rhs.pos[0] && pos[1] == rhs.pos[1];
+            case Gate_type::SWAP:
+                return same(0, 1);
+            case Gate_type::FRED:
+                return pos[0] == rhs.pos[0] && same(1, 2);
+            case Gate_type::TOF:
+                return same(0, 1) && pos[2] == rhs.pos[2];
+            }
+
+            return false;
+        }
+    };
+
+  protected:
+    idx N_;                   ///< Number of bits
+    std::vector<Gate> gates_; ///< Gates, in order of execution
+
+    /**
+     * \brief Records a gate
+     *
+     * \param gate Gate
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& add_(const Gate& gate) {
+        // EXCEPTION CHECKS
+
+        for (idx i = 0; i < gate.size(); ++i)
+            if (gate.pos[i] >= N_)
+                throw exception::OutOfRange(
+                    "qpp::Compiled_bit_circuit::add_()");
+        // END EXCEPTION CHECKS
+
+        gates_.emplace_back(gate);
+
+        return *this;
+    }
+
+  public:
+    /**
+     * \brief Constructor, empty circuit
+     *
+     * \param N Number of bits in the circuit
+     */
+    explicit Compiled_bit_circuit(idx N) : N_{N}, gates_{} {}
+
+    /**
+     * \brief Number of bits in the circuit
+     *
+     * \return Number of bits in the circuit
+     */
+    idx get_nb() const noexcept { return N_; }
+
+    /**
+     * \brief Gates of the circuit
+     *
+     * \return Const reference to the gates, in order of execution
+     */
+    const std::vector<Gate>& get_gates() const noexcept { return gates_; }
+
+    /**
+     * \brief Number of gates
+     *
+     * \return Number of gates
+     */
+    idx get_gate_count() const noexcept { return gates_.size(); }
+
+    /* gates, recorded */
+    /**
+     * \brief Bit flip
+     *
+     * \param pos Bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& X(idx pos) {
+        return add_(Gate{Gate_type::NOT, {pos, 0, 0}});
+    }
+
+    /**
+     * \brief Bit flip
+     *
+     * \param pos Bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& NOT(idx pos) { return X(pos); }
+
+    /**
+     * \brief Controlled-NOT
+     *
+     * \param ctrl Control bit position in the circuit
+     * \param target Target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& CNOT(idx ctrl, idx target) {
+        return add_(Gate{Gate_type::CNOT, {ctrl, target, 0}});
+    }
+
+    /**
+     * \brief Toffoli gate
+     *
+     * \param ctrl1 First control bit position in the circuit
+     * \param ctrl2 Second control bit position in the circuit
+     * \param target Target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& TOF(idx ctrl1, idx ctrl2, idx target) {
+        return add_(Gate{Gate_type::TOF, {ctrl1, ctrl2, target}});
+    }
+
+    /**
+     * \brief Swap bits
+     *
+     * \param pos1 First bit position in the circuit
+     * \param pos2 Second bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& SWAP(idx pos1, idx pos2) {
+        return add_(Gate{Gate_type::SWAP, {pos1, pos2, 0}});
+    }
+
+    /**
+     * \brief Fredkin gate (Controlled-SWAP)
+     *
+     * \param ctrl Control bit position in the circuit
+     * \param target1 First target bit position in the circuit
+     * \param target2 Second target bit position in the circuit
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& FRED(idx ctrl, idx target1, idx target2) {
+        return add_(Gate{Gate_type::FRED, {ctrl, target1, target2}});
+    }
+
+    /**
+     * \brief Appends the gates of another circuit
+     *
+     * \param other Circuit over the same bits
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& add(const Compiled_bit_circuit& other) {
+        for (auto&& gate : other.gates_)
+            add_(gate);
+
+        return *this;
+    }
+
+    /* execution */
+    /**
+     * \brief Executes the gates on a circuit simulator
+     *
+     * \tparam Circuit qpp::Bit_circuit or qpp::Sliced_bit_circuit
+     * \param circuit Circuit simulator, modified in place
+     * \return Reference to \a circuit
+     */
+    template <typename Circuit>
+    Circuit& apply(Circuit& circuit) const {
+        for (auto&& gate : gates_) {
+            const idx* p = gate.pos;
+            switch (gate.type) {
+            case Gate_type::NOT:
+                circuit.X(p[0]);
+                break;
+            case Gate_type::CNOT:
+                circuit.CNOT(p[0], p[1]);
+                break;
+            case Gate_type::SWAP:
+                circuit.SWAP(p[0], p[1]);
+                break;
+            case Gate_type::FRED:
+                circuit.FRED(p[0], p[1], p[2]);
+                break;
+            case Gate_type::TOF:
+                circuit.TOF(p[0], p[1], p[2]);
+                break;
+            }
+        }
+
+        return circuit;
+    }
+
+    /**
+     * \brief Executes the gates on many inputs, in parallel
+     *
+     * The inputs are processed 256 at a time by a qpp::Sliced_bit_circuit,
+     * and the batches are distributed across threads.
+     *
+     * \param inputs Inputs, each of the same size as the circuit
+     * \return Outputs, in the same order as the inputs
+     */
+    std::vector<Dynamic_bitset>
+    run(const std::vector<Dynamic_bitset>& inputs) const {
+        // EXCEPTION CHECKS
+
+        for (auto&& elem : inputs)
+            if (elem.size() != N_)
+                throw exception::SizeMismatch(
+                    "qpp::Compiled_bit_circuit::run()");
+        // END EXCEPTION CHECKS
+
+        using Sliced = Sliced_bit_circuit<4>;
+        const idx batch = Sliced::batch_size();
+        idx ninputs = inputs.size();
+        idx nbatches = (ninputs + batch - 1) / batch;
+        std::vector<Dynamic_bitset> result(ninputs, Dynamic_bitset{N_});
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+        {
+            Sliced circuit{N_};
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+            for (idx b = 0; b < nbatches; ++b) {
+                idx first = b * batch;
+                idx last = std::min(first + batch, ninputs);
+                circuit.reset();
+                for (idx i = first; i < last; ++i)
+                    circuit.set_input(i - first, inputs[i]);
+                apply(circuit);
+                for (idx i = first; i < last; ++i)
+                    result[i] = circuit.get_input(i - first);
+            }
+        }
+
+        return result;
+    }
+
+    /* transformations */
+    /**
+     * \brief Inverse circuit
+     *
+     * \return The gates in reverse order, all of them being self-inverse
+     */
+    Compiled_bit_circuit inverse() const {
+        Compiled_bit_circuit result{N_};
+        result.gates_.assign(gates_.rbegin(), gates_.rend());
+
+        return result;
+    }
+
+    /**
+     * \brief Depth of the circuit
+     *
+     * \return Number of layers of gates acting on disjoint bits, each gate
+     * being placed in the earliest possible layer
+     */
+    idx get_depth() const {
+        std::vector<idx> layer(N_, 0); // depth reached on each bit
+        idx result = 0;
+        for (auto&& gate : gates_) {
+            idx current = 0;
+            for (idx i = 0; i < gate.size(); ++i)
+                current = std::max(current, layer[gate.pos[i]]);
+            ++current;
+            for (idx i = 0; i < gate.size(); ++i)
+                layer[gate.pos[i]] = current;
+            result = std::max(result, current);
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Removes the gates that do not influence the output bits
+     *
+     * A gate is dead if none of the bits it writes is read afterwards, by a
+     * later gate (as a control or as a target of SWAP/FRED) or as an output.
+     *
+     * \param outputs Bits whose final values matter
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& remove_dead_gates(const std::vector<idx>& outputs) {
+        // EXCEPTION CHECKS
+
+        for (auto&& elem : outputs)
+            if (elem >= N_)
+                throw exception::OutOfRange(
+                    "qpp::Compiled_bit_circuit::remove_dead_gates()");
+        // END EXCEPTION CHECKS
+
+        // backward liveness analysis
+        std::vector<bool> live(N_, false);
+        for (auto&& elem : outputs)
+            live[elem] = true;
+        std::vector<bool> keep(gates_.size(), true);
+        for (idx k = gates_.size(); k-- > 0;) {
+            const idx* p = gates_[k].pos;
+            switch (gates_[k].type) {
+            case Gate_type::NOT:
+                keep[k] = live[p[0]];
+                break;
+            case Gate_type::CNOT:
+                keep[k] = live[p[1]];
+                if (keep[k])
+                    live[p[0]] = true;
+                break;
+            case Gate_type::TOF:
+                keep[k] = live[p[2]];
+                if (keep[k])
+                    live[p[0]] = live[p[1]] = true;
+                break;
+            case Gate_type::SWAP: {
+                bool live0 = live[p[0]];
+                live[p[0]] = live[p[1]];
+                live[p[1]] = live0;
+                keep[k] = live[p[0]] || live[p[1]];
+                break;
+            }
+            case Gate_type::FRED:
+                keep[k] = live[p[1]] || live[p[2]];
+                if (keep[k])
+                    live[p[0]] = live[p[1]] = live[p[2]] = true;
+                break;
+            }
+        }
+
+        idx n = 0;
+        for (idx k = 0; k < gates_.size(); ++k)
+            if (keep[k])
+                gates_[n++] = gates_[k];
+        gates_.resize(n);
+
+        return *this;
+    }
+
+    /**
+     * \brief Cancels the pairs of identical gates that are adjacent on all
+     * the bits they act on, repeatedly (all gates are self-inverse)
+     *
+     * \return Reference to the current instance
+     */
+    Compiled_bit_circuit& cancel_pairs() {
+        // last[b] holds the kept gates acting on the bit b, in order
+        std::vector<std::vector<idx>> last(N_);
+        std::vector<bool> keep(gates_.size(), true);
+        for (idx k = 0; k < gates_.size(); ++k) {
+            const Gate& gate = gates_[k];
+            idx n = gate.size();
+            // the previous gate on the first bit must be the previous one on
+            // all the other bits
+            bool cancel = !last[gate.pos[0]].empty();
+            idx prev = cancel ? last[gate.pos[0]].back() : 0;
+            cancel = cancel && gates_[prev] == gate;
+            for (idx i = 1; cancel && i < n; ++i)
+                cancel = !last[gate.pos[i]].empty() &&
+                         last[gate.pos[i]].back() == prev;
+            if (cancel) {
+                keep[prev] = keep[k] = false;
+                for (idx i = 0; i < n; ++i)
+                    last[gate.pos[i]].pop_back();
+            } else {
+                for (idx i = 0; i < n; ++i)
+                    last[gate.pos[i]].emplace_back(k);
+            }
+        }
+
+        idx n = 0;
+        for (idx k = 0; k < gates_.size(); ++k)
+            if (keep[k])
+                gates_[n++] = gates_[k];
+        gates_.resize(n);
+
+        return *this;
+    }
+
+  private:
+    /**
+     * \brief qpp::IDisplay::display() override, displays the gates, one per
+     * line
+     *
+     * \param os Output stream passed by reference
+     * \return Reference to the output stream
+     */
+    std::ostream& display(std::ostream& os) const override {
+        static const char* names[] = {"NOT", "CNOT", "SWAP", "FRED", "TOF"};
+        for (idx k = 0; k < gates_.size(); ++k) {
+            const Gate& gate = gates_[k];
+            os << names[static_cast<idx>(gate.type)];
+            for (idx i = 0; i < gate.size(); ++i)
+                os << ' ' << gate.pos[i];
+            if (k + 1 < gates_.size())
+                os << '\n';
+        }
+
+        return os;
+    }
+}; /* class Compiled_bit_circuit */
+
 } /* namespace qpp */
 
 #endif /* CLASSES_REVERSIBLE_H */
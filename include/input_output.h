@@ -115,14 +115,22 @@ disp(const PointerType* p, idx N, const std::string& separator,
 /**
  * \brief Saves Eigen expression to a binary file (internal format) in double
  * precision
- * \see qpp::load()
+ * \see qpp::load(), qpp::load_slice()
+ *
+ * The elements are written in column-major order, in chunks of \a chunk
+ * elements, in parallel. The file starts with a typed header (format
+ * version, byte order, scalar type, dimensions) followed by the CRC-32 of
+ * each chunk, verified when loading.
  *
  * \param A Eigen expression
  * \param fname Output file name
+ * \param chunk Number of elements per chunk
  */
 template <typename Derived>
-void save(const Eigen::MatrixBase<Derived>& A, const std::string& fname) {
-    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+void save(const Eigen::MatrixBase<Derived>& A, const std::string& fname,
+          idx chunk = 65536) {
+    using Scalar = typename Derived::Scalar;
+    const dyn_mat<Scalar>& rA = A.derived();
 
     // EXCEPTION CHECKS
 
@@ -130,8 +138,11 @@ void save(const Eigen::MatrixBase<Derived>& A, const std::string& fname) {
     if (!internal::check_nonzero_size(rA))
         throw exception::ZeroSize("qpp::save()");
 
+    if (chunk == 0)
+        throw exception::OutOfRange("qpp::save()");
+
     std::fstream fout;
-    fout.open(fname, std::ios::out | std::ios::binary);
+    fout.open(fname, std::ios::out | std::ios::binary | std::ios::trunc);
 
     if (fout.fail()) {
         throw std::runtime_error("qpp::save(): Error writing output file \"" +
@@ -139,30 +150,73 @@ void save(const Eigen::MatrixBase<Derived>& A, const std::string& fname) {
     }
     // END EXCEPTION CHECKS
 
-    // write the header to file
-    const std::string header_ = "TYPE::Eigen::Matrix";
-    fout.write(header_.c_str(), header_.length());
+    idx N = static_cast<idx>(rA.size());
+    internal::ChunkedHeader header{};
+    std::strncpy(header.magic, internal::chunked_magic(), 16);
+    header.version = 1;
+    header.byte_order = 0x01020304u;
+    header.scalar_kind = internal::scalar_kind<Scalar>();
+    header.scalar_size = sizeof(Scalar);
+    header.rows = static_cast<std::uint64_t>(rA.rows());
+    header.cols = static_cast<std::uint64_t>(rA.cols());
+    header.chunk = chunk;
+    header.nchunks = (N + chunk - 1) / chunk;
+    idx nchunks = static_cast<idx>(header.nchunks);
+    std::vector<std::uint32_t> crcs(nchunks);
+    std::streamoff data_start = static_cast<std::streamoff>(
+        sizeof(header) + (nchunks + 1) * sizeof(std::uint32_t));
 
-    idx rows = static_cast<idx>(rA.rows());
-    idx cols = static_cast<idx>(rA.cols());
-    fout.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
-    fout.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
-
-    fout.write(reinterpret_cast<const char*>(rA.data()),
-               sizeof(typename Derived::Scalar) * rows * cols);
+    // each thread writes (and checksums) its chunks through its own stream
+    bool ok = true;
+#ifdef WITH_OPENMP_
+#pragma omp parallel reduction(&& : ok)
+#endif // WITH_OPENMP_
+    {
+        std::fstream fchunk{fname,
+                            std::ios::in | std::ios::out | std::ios::binary};
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < nchunks; ++c) {
+            idx len = std::min(chunk, N - c * chunk) * sizeof(Scalar);
+            const char* p =
+                reinterpret_cast<const char*>(rA.data() + c * chunk);
+            crcs[c] = internal::crc32(p, len);
+            fchunk.seekp(data_start + static_cast<std::streamoff>(
+                                          c * chunk * sizeof(Scalar)));
+            fchunk.write(p, static_cast<std::streamsize>(len));
+        }
+        ok = !fchunk.fail();
+    }
 
+    // header and chunk CRCs
+    std::uint32_t crc = internal::crc32(crcs.data(), nchunks * sizeof(crc),
+                                        internal::crc32(&header,
+                                                        sizeof(header)));
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(crcs.data()),
+               static_cast<std::streamsize>(nchunks * sizeof(crc)));
+    fout.write(reinterpret_cast<const char*>(&crc), sizeof(crc));
     fout.close();
+
+    if (!ok || fout.fail()) {
+        throw std::runtime_error("qpp::save(): Error writing output file \"" +
+                                 std::string(fname) + "\"!");
+    }
 }
 
 /**
  * \brief Loads Eigen matrix from a binary file (internal format) in double
  * precision
- * \see qpp::save()
+ * \see qpp::save(), qpp::load_slice()
  *
  * The template parameter cannot be automatically deduced and
  * must be explicitly provided, depending on the scalar field of the matrix
  * that is being loaded.
  *
+ * The chunks are read in parallel and their CRC-32 verified. Files written
+ * by earlier versions (without chunks) are loaded as well, unverified.
+ *
  * Example:
  * \code
  * // loads a previously saved Eigen dynamic complex matrix from "input.bin"
@@ -173,6 +227,7 @@ void save(const Eigen::MatrixBase<Derived>& A, const std::string& fname) {
  */
 template <typename Derived>
 dyn_mat<typename Derived::Scalar> load(const std::string& fname) {
+    using Scalar = typename Derived::Scalar;
     std::fstream fin;
     fin.open(fname, std::ios::in | std::ios::binary);
 
@@ -183,29 +238,177 @@ dyn_mat<typename Derived::Scalar> load(const std::string& fname) {
                                  std::string(fname) + "\"!");
     }
 
-    const std::string header_ = "TYPE::Eigen::Matrix";
-    std::unique_ptr<char[]> fheader_{new char[header_.length()]};
+    char magic[16]{};
+    fin.read(magic, sizeof(magic));
+    fin.clear();
+    // END EXCEPTION CHECKS
+
+    // format without chunks
+    if (std::strncmp(magic, internal::chunked_magic(), 16) != 0) {
+        fin.seekg(0);
+        const std::string header_ = "TYPE::Eigen::Matrix";
+        std::unique_ptr<char[]> fheader_{new char[header_.length()]};
+
+        // read the header from file
+        fin.read(fheader_.get(), header_.length());
+        if (std::string(fheader_.get(), header_.length()) != header_) {
+            throw std::runtime_error("qpp::load(): Input file \"" +
+                                     std::string(fname) + "\" is corrupted!");
+        }
+
+        idx rows, cols;
+        fin.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+        fin.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+
+        dyn_mat<Scalar> A(rows, cols);
+
+        fin.read(reinterpret_cast<char*>(A.data()),
+                 sizeof(Scalar) * rows * cols);
+
+        fin.close();
+
+        return A;
+    }
+
+    internal::ChunkedHeader header{};
+    std::vector<std::uint32_t> crcs;
+    internal::read_chunked_header<Scalar>(fin, fname, "qpp::load()", header,
+                                          crcs);
+    std::streamoff data_start = fin.tellg();
+    fin.close();
 
-    // read the header from file
-    fin.read(fheader_.get(), header_.length());
-    if (std::string(fheader_.get(), header_.length()) != header_) {
+    dyn_mat<Scalar> A(static_cast<idx>(header.rows),
+                      static_cast<idx>(header.cols));
+    idx N = static_cast<idx>(A.size());
+    idx chunk = static_cast<idx>(header.chunk);
+    idx nchunks = crcs.size();
+
+    // each thread reads (and verifies) its chunks through its own stream
+    bool ok = true;
+#ifdef WITH_OPENMP_
+#pragma omp parallel reduction(&& : ok)
+#endif // WITH_OPENMP_
+    {
+        std::fstream fchunk{fname, std::ios::in | std::ios::binary};
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < nchunks; ++c) {
+            idx len = std::min(chunk, N - c * chunk) * sizeof(Scalar);
+            char* p = reinterpret_cast<char*>(A.data() + c * chunk);
+            fchunk.seekg(data_start + static_cast<std::streamoff>(
+                                          c * chunk * sizeof(Scalar)));
+            fchunk.read(p, static_cast<std::streamsize>(len));
+            if (!fchunk || internal::crc32(p, len) != crcs[c]) {
+                ok = false;
+                fchunk.clear();
+            }
+        }
+    }
+
+    if (!ok) {
         throw std::runtime_error("qpp::load(): Input file \"" +
                                  std::string(fname) + "\" is corrupted!");
     }
-    // END EXCEPTION CHECKS
 
-    idx rows, cols;
-    fin.read(reinterpret_cast<char*>(&rows), sizeof(rows));
-    fin.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+    return A;
+}
 
-    dyn_mat<typename Derived::Scalar> A(rows, cols);
+/**
+ * \brief Loads a slice of the elements of an Eigen matrix from a binary file
+ * written by qpp::save()
+ * \see qpp::save(), qpp::load()
+ *
+ * Only the chunks that overlap the slice are read, and their CRC-32
+ * verified. The template parameter cannot be automatically deduced and
+ * must be explicitly provided, as for qpp::load().
+ *
+ * Example:
+ * \code
+ * // loads the first 1024 amplitudes of a state vector saved in "psi.bin"
+ * ket amplitudes = load_slice<ket>("psi.bin", 0, 1024);
+ * \endcode
+ *
+ * \param fname Input file name
+ * \param first Index of the first element, in column-major order
+ * \param count Number of elements
+ * \return Column vector with the elements \a first, ...,
+ * \a first + \a count - 1
+ */
+template <typename Derived>
+dyn_col_vect<typename Derived::Scalar>
+load_slice(const std::string& fname, idx first, idx count) {
+    using Scalar = typename Derived::Scalar;
+    std::fstream fin;
+    fin.open(fname, std::ios::in | std::ios::binary);
 
-    fin.read(reinterpret_cast<char*>(A.data()),
-             sizeof(typename Derived::Scalar) * rows * cols);
+    // EXCEPTION CHECKS
 
+    if (fin.fail()) {
+        throw std::runtime_error(
+            "qpp::load_slice(): Error opening input file \"" +
+            std::string(fname) + "\"!");
+    }
+
+    internal::ChunkedHeader header{};
+    std::vector<std::uint32_t> crcs;
+    internal::read_chunked_header<Scalar>(fin, fname, "qpp::load_slice()",
+                                          header, crcs);
+
+    idx N = static_cast<idx>(header.rows * header.cols);
+    if (count == 0)
+        throw exception::ZeroSize("qpp::load_slice()");
+    if (first >= N || count > N - first)
+        throw exception::OutOfRange("qpp::load_slice()");
+    // END EXCEPTION CHECKS
+
+    std::streamoff data_start = fin.tellg();
     fin.close();
 
-    return A;
+    dyn_col_vect<Scalar> result(count);
+    idx chunk = static_cast<idx>(header.chunk);
+    idx first_chunk = first / chunk;
+    idx nchunks = (first + count - 1) / chunk + 1 - first_chunk;
+
+    // each thread reads (and verifies) its chunks through its own stream
+    bool ok = true;
+#ifdef WITH_OPENMP_
+#pragma omp parallel reduction(&& : ok)
+#endif // WITH_OPENMP_
+    {
+        std::fstream fchunk{fname, std::ios::in | std::ios::binary};
+        std::vector<Scalar> buffer(std::min(chunk, N));
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx k = 0; k < nchunks; ++k) {
+            idx c = first_chunk + k;
+            idx len = std::min(chunk, N - c * chunk);
+            fchunk.seekg(data_start + static_cast<std::streamoff>(
+                                          c * chunk * sizeof(Scalar)));
+            fchunk.read(reinterpret_cast<char*>(buffer.data()),
+                        static_cast<std::streamsize>(len * sizeof(Scalar)));
+            if (!fchunk || internal::crc32(buffer.data(),
+                                           len * sizeof(Scalar)) != crcs[c]) {
+                ok = false;
+                fchunk.clear();
+                continue;
+            }
+            // part of the chunk within the slice
+            idx lo = std::max(first, c * chunk);
+            idx hi = std::min(first + count, c * chunk + len);
+            std::copy(buffer.begin() + (lo - c * chunk),
+                      buffer.begin() + (hi - c * chunk),
+                      result.data() + (lo - first));
+        }
+    }
+
+    if (!ok) {
+        throw std::runtime_error("qpp::load_slice(): Input file \"" +
+                                 std::string(fname) + "\" is corrupted!");
+    }
+
+    return result;
 }
 
 } /* namespace qpp */
@@ -93,67 +93,21 @@ ip(const Eigen::MatrixBase<Derived>& phi, const Eigen::MatrixBase<Derived>& psi,
     idx D = static_cast<idx>(rpsi.rows());
     idx Dsubsys_bar = D / Dsubsys;
 
-    idx n = dims.size();
-    idx n_subsys = subsys.size();
-    idx n_subsys_bar = n - n_subsys;
-
-    idx Cdims[maxn];
-    idx Csubsys[maxn];
-    idx Cdimssubsys[maxn];
-    idx Csubsys_bar[maxn];
-    idx Cdimssubsys_bar[maxn];
-
-    std::vector<idx> subsys_bar = complement(subsys, n);
-    std::copy(std::begin(subsys_bar), std::end(subsys_bar),
-              std::begin(Csubsys_bar));
-
-    for (idx i = 0; i < n; ++i) {
-        Cdims[i] = dims[i];
-    }
-    for (idx i = 0; i < n_subsys; ++i) {
-        Csubsys[i] = subsys[i];
-        Cdimssubsys[i] = dims[subsys[i]];
-    }
-    for (idx i = 0; i < n_subsys_bar; ++i) {
-        Cdimssubsys_bar[i] = dims[subsys_bar[i]];
-    }
-
-    auto worker = [&](idx b) noexcept->typename Derived::Scalar {
-        idx Cmidxrow[maxn];
-        idx Cmidxrowsubsys[maxn];
-        idx Cmidxcolsubsys_bar[maxn];
-
-        /* get the col multi-indexes of the complement */
-        internal::n2multiidx(b, n_subsys_bar, Cdimssubsys_bar,
-                             Cmidxcolsubsys_bar);
-        /* write it in the global row multi-index */
-        for (idx k = 0; k < n_subsys_bar; ++k) {
-            Cmidxrow[Csubsys_bar[k]] = Cmidxcolsubsys_bar[k];
-        }
-
-        typename Derived::Scalar result = 0;
-        for (idx a = 0; a < Dsubsys; ++a) {
-            /* get the row multi-indexes of the subsys */
-            internal::n2multiidx(a, n_subsys, Cdimssubsys, Cmidxrowsubsys);
-            /* write it in the global row multi-index */
-            for (idx k = 0; k < n_subsys; ++k) {
-                Cmidxrow[Csubsys[k]] = Cmidxrowsubsys[k];
-            }
-            // compute the row index
-            idx i = internal::multiidx2n(Cmidxrow, n, Cdims);
-
-            result += std::conj(rphi(a)) * rpsi(i);
-        }
-
-        return result;
-    }; /* end worker */
+    // blocks over the subsystems that are not in subsys, and offsets of the
+    // basis states of subsys within a block
+    internal::IndexPlan plan{dims, subsys};
+    std::vector<idx> offsets = plan.offsets(subsys);
 
     dyn_col_vect<typename Derived::Scalar> result(Dsubsys_bar);
 #ifdef WITH_OPENMP_
-#pragma omp parallel for
+#pragma omp parallel
 #endif // WITH_OPENMP_
-    for (idx m = 0; m < Dsubsys_bar; ++m)
-        result(m) = worker(m);
+    plan.for_each([&](idx m, idx base) {
+        typename Derived::Scalar sm = 0;
+        for (idx a = 0; a < Dsubsys; ++a)
+            sm += std::conj(rphi(a)) * rpsi(base + offsets[a]);
+        result(m) = sm;
+    });
 
     return result;
 }
@@ -195,6 +149,10 @@ ip(const Eigen::MatrixBase<Derived>& phi, const Eigen::MatrixBase<Derived>& psi,
  * \brief Measures the state vector or density operator \a A using the set of
  * Kraus operators \a Ks
  *
+ * \note The post-measurement states have the precision of \a A, e.g. they
+ * are in single precision for a qpp::ket_f \a A, see qpp::state_scalar_t;
+ * the same holds for all the other measurement functions
+ *
  * \param A Eigen expression
  * \param Ks Set of Kraus operators
  * \return Tuple of: 1. Result of the measurement, 2.
@@ -202,7 +160,8 @@ ip(const Eigen::MatrixBase<Derived>& phi, const Eigen::MatrixBase<Derived>& psi,
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
     const dyn_mat<typename Derived::Scalar>& rA = A.derived();
 
@@ -224,32 +183,39 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
             throw exception::DimsNotEqual("qpp::measure()");
     // END EXCEPTION CHECKS
 
+    // the resulting states keep the precision of A, see qpp::state_scalar_t
+    using Scalar = state_scalar_t<typename Derived::Scalar>;
+    using Real = typename Eigen::NumTraits<Scalar>::Real;
+
     // probabilities
     std::vector<double> prob(Ks.size());
     // resulting states
-    std::vector<cmat> outstates(Ks.size());
+    std::vector<dyn_mat<Scalar>> outstates(Ks.size());
 
     //************ density matrix ************//
     if (internal::check_square_mat(rA)) // square matrix
     {
         for (idx i = 0; i < Ks.size(); ++i) {
-            outstates[i] = cmat::Zero(rA.rows(), rA.rows());
-            cmat tmp = Ks[i] * rA * adjoint(Ks[i]); // un-normalized;
-            prob[i] = std::abs(trace(tmp));         // probability
+            dyn_mat<Scalar> K = Ks[i].template cast<Scalar>();
+            outstates[i] = dyn_mat<Scalar>::Zero(rA.rows(), rA.rows());
+            dyn_mat<Scalar> tmp = K * rA * adjoint(K); // un-normalized;
+            prob[i] = std::abs(trace(tmp));            // probability
             if (prob[i] > eps)
-                outstates[i] = tmp / prob[i]; // normalized
+                outstates[i] = tmp / static_cast<Real>(prob[i]); // normalized
         }
     }
     //************ ket ************//
     else if (internal::check_cvector(rA)) // column vector
     {
         for (idx i = 0; i < Ks.size(); ++i) {
-            outstates[i] = ket::Zero(rA.rows());
-            ket tmp = Ks[i] * rA; // un-normalized;
+            dyn_mat<Scalar> K = Ks[i].template cast<Scalar>();
+            outstates[i] = dyn_col_vect<Scalar>::Zero(rA.rows());
+            dyn_col_vect<Scalar> tmp = K * rA; // un-normalized;
             // probability
             prob[i] = std::pow(norm(tmp), 2);
             if (prob[i] > eps)
-                outstates[i] = tmp / std::sqrt(prob[i]); // normalized
+                outstates[i] =
+                    tmp / static_cast<Real>(std::sqrt(prob[i])); // normalized
         }
     } else
         throw exception::MatrixNotSquareNorCvector("qpp::measure()");
@@ -281,7 +247,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A,
         const std::initializer_list<cmat>& Ks) {
     return measure(A, std::vector<cmat>(Ks));
@@ -298,7 +265,8 @@ measure(const Eigen::MatrixBase<Derived>& A,
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A, const cmat& U) {
     const dyn_mat<typename Derived::Scalar>& rA = A.derived();
 
@@ -342,7 +310,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& U) {
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
         const std::vector<idx>& target, const std::vector<idx>& dims) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -381,11 +350,15 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
             throw exception::DimsNotEqual("qpp::measure()");
     // END EXCEPTION CHECKS
 
+    // the resulting states keep the precision of A, see qpp::state_scalar_t
+    using Scalar = state_scalar_t<typename Derived::Scalar>;
+    using Real = typename Eigen::NumTraits<Scalar>::Real;
+
     // probabilities
     std::vector<double> prob(Ks.size());
     // resulting states
-    std::vector<cmat> outstates(Ks.size(),
-                                cmat::Zero(Dsubsys_bar, Dsubsys_bar));
+    std::vector<dyn_mat<Scalar>> outstates(
+        Ks.size(), dyn_mat<Scalar>::Zero(Dsubsys_bar, Dsubsys_bar));
 
     //************ density matrix ************//
     if (internal::check_square_mat(rA)) // square matrix
@@ -394,13 +367,13 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
         if (!internal::check_dims_match_mat(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::measure()");
         for (idx i = 0; i < Ks.size(); ++i) {
-            cmat tmp = apply(rA, Ks[i], target, dims);
+            dyn_mat<Scalar> tmp = apply(rA, Ks[i], target, dims);
             tmp = ptrace(tmp, target, dims);
             prob[i] = std::abs(trace(tmp)); // probability
             if (prob[i] > eps) {
                 // normalized output state
                 // corresponding to measurement result i
-                outstates[i] = tmp / prob[i];
+                outstates[i] = tmp / static_cast<Real>(prob[i]);
             }
         }
     }
@@ -411,12 +384,12 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
         if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchCvector("qpp::measure()");
         for (idx i = 0; i < Ks.size(); ++i) {
-            ket tmp = apply(rA, Ks[i], target, dims);
+            dyn_col_vect<Scalar> tmp = apply(rA, Ks[i], target, dims);
             prob[i] = std::pow(norm(tmp), 2);
             if (prob[i] > eps) {
                 // normalized output state
                 // corresponding to measurement result i
-                tmp /= std::sqrt(prob[i]);
+                tmp /= static_cast<Real>(std::sqrt(prob[i]));
                 outstates[i] = ptrace(tmp, target, dims);
             }
         }
@@ -456,7 +429,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A,
         const std::initializer_list<cmat>& Ks, const std::vector<idx>& target,
         const std::vector<idx>& dims) {
@@ -480,7 +454,8 @@ measure(const Eigen::MatrixBase<Derived>& A,
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
         const std::vector<idx>& target, idx d = 2) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -522,7 +497,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A,
         const std::initializer_list<cmat>& Ks, const std::vector<idx>& target,
         idx d = 2) {
@@ -548,7 +524,8 @@ measure(const Eigen::MatrixBase<Derived>& A,
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
         const std::vector<idx>& target, const std::vector<idx>& dims) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -580,25 +557,30 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
         throw exception::DimsMismatchMatrix("qpp::measure()");
     // END EXCEPTION CHECKS
 
+    // the resulting states keep the precision of A, see qpp::state_scalar_t
+    using Scalar = state_scalar_t<typename Derived::Scalar>;
+    using Real = typename Eigen::NumTraits<Scalar>::Real;
+
     // number of basis elements or number of rank-1 projectors
     idx M = static_cast<idx>(V.cols());
 
     //************ ket ************//
     if (internal::check_cvector(rA)) {
-        const ket& rpsi = A.derived();
+        const dyn_col_vect<Scalar>& rpsi = A.derived();
         // check that dims match state vector
         if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchCvector("qpp::measure()");
 
-        std::vector<double> prob(M);    // probabilities
-        std::vector<cmat> outstates(M); // resulting states
+        std::vector<double> prob(M);               // probabilities
+        std::vector<dyn_mat<Scalar>> outstates(M); // resulting states
 
 #ifdef WITH_OPENMP_
 #pragma omp parallel for
 #endif // WITH_OPENMP_
         for (idx i = 0; i < M; ++i)
             outstates[i] =
-                ip(static_cast<const ket&>(V.col(i)), rpsi, target, dims);
+                ip(dyn_col_vect<Scalar>(V.col(i).template cast<Scalar>()),
+                   rpsi, target, dims);
 
         for (idx i = 0; i < M; ++i) {
             double tmp = norm(outstates[i]);
@@ -606,7 +588,7 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
             if (prob[i] > eps) {
                 // normalized output state
                 // corresponding to measurement result m
-                outstates[i] /= tmp;
+                outstates[i] /= static_cast<Real>(tmp);
             }
         }
 
@@ -657,7 +639,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
  * normalized states
  */
 template <typename Derived>
-std::tuple<idx, std::vector<double>, std::vector<cmat>>
+std::tuple<idx, std::vector<double>,
+           std::vector<dyn_mat<state_scalar_t<typename Derived::Scalar>>>>
 measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
         const std::vector<idx>& target, idx d = 2) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -693,7 +676,8 @@ measure(const Eigen::MatrixBase<Derived>& A, const cmat& V,
  * index), 2. Outcome probability, and 3. Post-measurement normalized state
  */
 template <typename Derived>
-std::tuple<std::vector<idx>, double, cmat>
+std::tuple<std::vector<idx>, double,
+           dyn_mat<state_scalar_t<typename Derived::Scalar>>>
 measure_seq(const Eigen::MatrixBase<Derived>& A, std::vector<idx> target,
             std::vector<idx> dims) {
     //    typename std::remove_const<
@@ -735,17 +719,45 @@ measure_seq(const Eigen::MatrixBase<Derived>& A, std::vector<idx> target,
     // the order of measurements does not matter
     std::sort(std::begin(target), std::end(target), std::greater<idx>{});
 
-    //************ density matrix or column vector ************//
-    while (target.size() > 0) {
-        auto tmp = measure(cA, Gates::get_instance().Id(dims[target[0]]),
-                           {target[0]}, dims);
-        result.push_back(std::get<0>(tmp));
-        prob *= std::get<1>(tmp)[std::get<0>(tmp)];
-        cA = std::get<2>(tmp)[std::get<0>(tmp)];
-
-        // remove the subsystem
-        dims.erase(std::next(std::begin(dims), target[0]));
-        target.erase(std::begin(target));
+    //************ ket ************//
+    if (internal::check_cvector(cA)) {
+        auto& gen =
+#ifdef NO_THREAD_LOCAL_
+            RandomDevices::get_instance().get_prng();
+#else
+            RandomDevices::get_thread_local_instance().get_prng();
+#endif
+        // marginal probabilities, sampling, then collapse of the sampled
+        // outcome only
+        while (target.size() > 0) {
+            std::vector<double> probs =
+                internal::marginal_probs_ket(cA, target[0], dims);
+            std::discrete_distribution<idx> dd(std::begin(probs),
+                                               std::end(probs));
+            idx m = dd(gen);
+            result.push_back(m);
+            prob *= probs[m];
+            double scale = probs[m] > eps ? 1 / std::sqrt(probs[m]) : 1;
+            cA = internal::collapse_ket(cA, target[0], m, dims, scale);
+
+            // remove the subsystem
+            dims.erase(std::next(std::begin(dims), target[0]));
+            target.erase(std::begin(target));
+        }
+    }
+    //************ density matrix ************//
+    else {
+        while (target.size() > 0) {
+            auto tmp = measure(cA, Gates::get_instance().Id(dims[target[0]]),
+                               {target[0]}, dims);
+            result.push_back(std::get<0>(tmp));
+            prob *= std::get<1>(tmp)[std::get<0>(tmp)];
+            cA = std::get<2>(tmp)[std::get<0>(tmp)];
+
+            // remove the subsystem
+            dims.erase(std::next(std::begin(dims), target[0]));
+            target.erase(std::begin(target));
+        }
     }
     // order result in increasing order with respect to target
     std::reverse(std::begin(result), std::end(result));
@@ -767,7 +779,8 @@ measure_seq(const Eigen::MatrixBase<Derived>& A, std::vector<idx> target,
  * index), 2. Outcome probability, and 3. Post-measurement normalized state
  */
 template <typename Derived>
-std::tuple<std::vector<idx>, double, cmat>
+std::tuple<std::vector<idx>, double,
+           dyn_mat<state_scalar_t<typename Derived::Scalar>>>
 measure_seq(const Eigen::MatrixBase<Derived>& A, std::vector<idx> target,
             idx d = 2) {
     const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA = A.derived();
@@ -0,0 +1,219 @@
+/*
+ * This file is part of Quantum++.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2013 - 2019 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file internal/classes/index_plan.h
+ * \brief Precomputed subsystem index plan
+ */
+
+#ifndef INTERNAL_CLASSES_INDEX_PLAN_H_
+#define INTERNAL_CLASSES_INDEX_PLAN_H_
+
+namespace qpp {
+namespace internal // internal class, do not modify
+{
+/**
+ * \class qpp::internal::IndexPlan
+ * \brief Subsystem index plan, used internally by the kernels that visit a
+ * multi-partite state block by block
+ *
+ * The plan is built once for a dimension vector and a list of fixed
+ * subsystems (e.g. the control and target subsystems of a gate). It holds the
+ * strides of all subsystems and enumerates the indexes of the basis states in
+ * which all fixed subsystems are in the state \f$|0\rangle\f$ (the \a bases
+ * of the blocks), in standard lexicographical order of the other subsystems.
+ * The enumeration is incremental (odometer-like), so that no division is
+ * performed per block, as opposed to qpp::internal::n2multiidx() followed by
+ * qpp::internal::multiidx2n().
+ *
+ * Example:
+ * \code
+ * IndexPlan plan{dims, target};
+ * std::vector<idx> offsets = plan.offsets(target); // offsets in a block
+ * #pragma omp parallel
+ * {
+ *     plan.for_each([&](idx r, idx base) {
+ *         // the block r spans the indexes base + offsets[m]
+ *     });
+ * }
+ * \endcode
+ */
+class IndexPlan {
+    std::vector<idx> dims_;         ///< dimensions of all subsystems
+    std::vector<idx> strides_;      ///< strides of all subsystems
+    std::vector<idx> Cdims_bar_;    ///< dimensions of the enumerated subsystems
+    std::vector<idx> Cstrides_bar_; ///< strides of the enumerated subsystems
+    std::vector<idx> carry_;        ///< base increment when a digit is bumped
+    idx D_bar_;                     ///< number of blocks
+
+  public:
+    /**
+     * \brief Constructs the plan
+     *
+     * \param dims Dimensions of the multi-partite system
+     * \param fixed Fixed subsystems, the blocks are enumerated over all the
+     * other ones
+     */
+    IndexPlan(const std::vector<idx>& dims, const std::vector<idx>& fixed)
+        : dims_(dims), strides_(dims.size()), Cdims_bar_{}, Cstrides_bar_{},
+          carry_{}, D_bar_{1} {
+        idx n = dims.size();
+        strides_[n - 1] = 1;
+        for (idx k = n - 1; k > 0; --k)
+            strides_[k - 1] = strides_[k] * dims[k];
+
+        std::vector<bool> is_fixed(n, false);
+        for (idx k : fixed)
+            is_fixed[k] = true;
+        for (idx k = 0; k < n; ++k)
+            if (!is_fixed[k]) {
+                Cdims_bar_.push_back(dims[k]);
+                Cstrides_bar_.push_back(strides_[k]);
+                D_bar_ *= dims[k];
+            }
+
+        // bumping the digit k resets all the digits after it; the increment
+        // "wraps around" in unsigned arithmetic, which is well-defined
+        idx n_bar = Cdims_bar_.size();
+        carry_.resize(n_bar);
+        idx reset = 0;
+        for (idx k = n_bar; k-- > 0;) {
+            carry_[k] = Cstrides_bar_[k] - reset;
+            reset += (Cdims_bar_[k] - 1) * Cstrides_bar_[k];
+        }
+    }
+
+    /**
+     * \brief Number of blocks
+     *
+     * \return Product of the dimensions of the non-fixed subsystems
+     */
+    idx size() const noexcept { return D_bar_; }
+
+    /**
+     * \brief Stride of a subsystem
+     *
+     * \param k Subsystem index
+     * \return Distance between the indexes of two basis states that differ
+     * by one in the subsystem \a k only
+     */
+    idx stride(idx k) const noexcept { return strides_[k]; }
+
+    /**
+     * \brief Offsets of the basis states of a part of the system
+     *
+     * \param subsys Subsystem indexes
+     * \return Offsets of the basis states of \a subsys, in standard
+     * lexicographical order of \a subsys (in the given order), with all the
+     * other subsystems in the state \f$|0\rangle\f$
+     */
+    std::vector<idx> offsets(const std::vector<idx>& subsys) const {
+        std::vector<idx> result{0};
+        // expand the digits from the most significant one, one at a time
+        for (idx k : subsys) {
+            idx dim = dims_[k];
+            std::vector<idx> expanded;
+            expanded.reserve(result.size() * dim);
+            for (idx offset : result)
+                for (idx i = 0; i < dim; ++i)
+                    expanded.push_back(offset + i * strides_[k]);
+            result = std::move(expanded);
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Positions the odometer on a block
+     *
+     * \param r Block index, less than qpp::internal::IndexPlan::size()
+     * \param midx Multi-index of the enumerated subsystems, written
+     * \return Base of the block \a r
+     */
+    idx first(idx r, idx* midx) const noexcept {
+        idx n_bar = Cdims_bar_.size();
+        idx base = 0;
+        for (idx k = n_bar; k-- > 0;) {
+            midx[k] = r % Cdims_bar_[k];
+            r /= Cdims_bar_[k];
+            base += midx[k] * Cstrides_bar_[k];
+        }
+        return base;
+    }
+
+    /**
+     * \brief Advances the odometer to the next block
+     *
+     * \param midx Multi-index of the enumerated subsystems, updated
+     * \param base Base of the current block
+     * \return Base of the next block
+     */
+    idx next(idx* midx, idx base) const noexcept {
+        for (idx k = Cdims_bar_.size(); k-- > 0;) {
+            if (++midx[k] < Cdims_bar_[k])
+                return base + carry_[k];
+            midx[k] = 0;
+        }
+        return 0;
+    }
+
+    /**
+     * \brief Visits all blocks
+     *
+     * Calls \a f(r, base) for each block r, in chunks of consecutive blocks
+     * so that each chunk is positioned once. The chunks are shared among the
+     * threads of the enclosing OpenMP parallel region, if any (orphaned
+     * worksharing loop), hence \a f must be safe to call concurrently on
+     * different blocks.
+     *
+     * \param f Callable with signature void(idx, idx)
+     */
+    template <typename F>
+    void for_each(F&& f) const {
+        // blocks per chunk
+        const idx chunk = 1024;
+        idx nchunks = (D_bar_ + chunk - 1) / chunk;
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < nchunks; ++c) {
+            idx midx[maxn];
+            idx r = c * chunk;
+            idx last = std::min(r + chunk, D_bar_);
+            idx base = first(r, midx);
+            for (; r < last; ++r) {
+                f(r, base);
+                base = next(midx, base);
+            }
+        }
+    }
+}; /* class IndexPlan */
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_CLASSES_INDEX_PLAN_H_ */
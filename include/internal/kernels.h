@@ -0,0 +1,1094 @@
+/*
+ * This file is part of Quantum++.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2013 - 2019 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file internal/kernels.h
+ * \brief Internal in-place state vector kernels
+ */
+
+#ifndef INTERNAL_KERNELS_H_
+#define INTERNAL_KERNELS_H_
+
+namespace qpp {
+namespace internal {
+// applies the DA x DA gate a (row-major) on a unit-stride run of amplitude
+// blocks, the m-th amplitude of the j-th block being p[offsetsA[m] + j]
+template <idx DA, typename Scalar>
+inline void qubit_run_(Scalar* p, idx run, const idx* offsetsA,
+                       const Scalar* a) noexcept {
+    for (idx j = 0; j < run; ++j) {
+        Scalar v[DA];
+        for (idx m = 0; m < DA; ++m)
+            v[m] = p[offsetsA[m] + j];
+        for (idx m = 0; m < DA; ++m) {
+            Scalar coeff = 0;
+            for (idx k = 0; k < DA; ++k)
+                coeff += a[m * DA + k] * v[k];
+            p[offsetsA[m] + j] = coeff;
+        }
+    }
+}
+
+// same as above, spelled out in real arithmetic on the interleaved
+// (real, imag) representation of std::complex, which the compiler is able to
+// vectorize; the std::complex member access and multiplication (with its
+// NaN/Inf recovery branch) are not
+template <idx DA, typename T>
+inline void qubit_run_(std::complex<T>* p, idx run, const idx* offsetsA,
+                       const std::complex<T>* a) noexcept {
+    T* q[DA];
+    for (idx m = 0; m < DA; ++m)
+        q[m] = reinterpret_cast<T*>(p + offsetsA[m]);
+    T a_re[DA * DA], a_im[DA * DA];
+    for (idx k = 0; k < DA * DA; ++k) {
+        a_re[k] = a[k].real();
+        a_im[k] = a[k].imag();
+    }
+    for (idx j = 0; j < run; ++j) {
+        T v_re[DA], v_im[DA];
+        for (idx m = 0; m < DA; ++m) {
+            v_re[m] = q[m][2 * j];
+            v_im[m] = q[m][2 * j + 1];
+        }
+        for (idx m = 0; m < DA; ++m) {
+            T re = 0, im = 0;
+            for (idx k = 0; k < DA; ++k) {
+                re += a_re[m * DA + k] * v_re[k] - a_im[m * DA + k] * v_im[k];
+                im += a_re[m * DA + k] * v_im[k] + a_im[m * DA + k] * v_re[k];
+            }
+            q[m][2 * j] = re;
+            q[m][2 * j + 1] = im;
+        }
+    }
+}
+
+// multiplies a unit-stride run of amplitudes by phase
+template <typename Scalar>
+inline void scale_run_(Scalar* p, idx run, Scalar phase) noexcept {
+    for (idx j = 0; j < run; ++j)
+        p[j] *= phase;
+}
+
+// same as above, in real arithmetic, vectorizable, see qubit_run_()
+template <typename T>
+inline void scale_run_(std::complex<T>* p, idx run,
+                       std::complex<T> phase) noexcept {
+    T* q = reinterpret_cast<T*>(p);
+    T phase_re = phase.real(), phase_im = phase.imag();
+    for (idx j = 0; j < run; ++j) {
+        T re = q[2 * j], im = q[2 * j + 1];
+        q[2 * j] = phase_re * re - phase_im * im;
+        q[2 * j + 1] = phase_re * im + phase_im * re;
+    }
+}
+
+// applies in place the 2^NT x 2^NT (controlled) gate A to the NT qubits
+// target of the n-qubit state vector psi, the gate acts whenever all control
+// qubits are set; no multi-index arithmetic, the fixed (control and target)
+// bits are inserted into a running index and the amplitudes are visited in
+// unit-stride runs, so that the innermost loop is branch-free
+template <idx NT, typename Derived>
+void apply_qubit_ket_inplace_(Eigen::MatrixBase<Derived>& psi,
+                              const dyn_mat<typename Derived::Scalar>& A,
+                              const std::vector<idx>& ctrl,
+                              const std::vector<idx>& target, idx n) {
+    using Scalar = typename Derived::Scalar;
+    constexpr idx DA = static_cast<idx>(1) << NT;
+    // maximum length of a unit-stride run
+    constexpr idx max_run = 64;
+
+    // row-major copy of the gate
+    Scalar a[DA * DA];
+    for (idx m = 0; m < DA; ++m)
+        for (idx j = 0; j < DA; ++j)
+            a[m * DA + j] = A(m, j);
+
+    // offsets of the gate amplitudes, the first target is the most
+    // significant qubit of the gate, same as for the generic kernel
+    idx offsetsA[DA];
+    for (idx m = 0; m < DA; ++m) {
+        offsetsA[m] = 0;
+        for (idx k = 0; k < NT; ++k)
+            if ((m >> (NT - k - 1)) & 1)
+                offsetsA[m] |= static_cast<idx>(1) << (n - target[k] - 1);
+    }
+
+    // strides of the fixed bits, sorted in increasing order, and control mask
+    std::vector<idx> fixed_strides;
+    idx ctrl_mask = 0;
+    for (idx k = 0; k < ctrl.size(); ++k) {
+        idx stride = static_cast<idx>(1) << (n - ctrl[k] - 1);
+        fixed_strides.push_back(stride);
+        ctrl_mask |= stride;
+    }
+    for (idx k = 0; k < NT; ++k)
+        fixed_strides.push_back(static_cast<idx>(1) << (n - target[k] - 1));
+    std::sort(std::begin(fixed_strides), std::end(fixed_strides));
+    idx nfixed = fixed_strides.size();
+
+    // the free bits below the smallest fixed bit give the unit-stride runs
+    idx D_free = static_cast<idx>(1) << (n - nfixed);
+    idx run = std::min(fixed_strides[0], max_run);
+    idx nruns = D_free / run;
+    Scalar* data = psi.derived().data();
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx r = 0; r < nruns; ++r) {
+        // insert the fixed bits, set all control bits
+        idx start = r * run;
+        for (idx k = 0; k < nfixed; ++k)
+            start += start & ~(fixed_strides[k] - 1);
+        start |= ctrl_mask;
+
+        qubit_run_<DA>(data + start, run, offsetsA, a);
+    }
+}
+
+// the powers A^1, A^2, ..., A^k of the square matrix A
+template <typename Scalar>
+std::vector<dyn_mat<Scalar>> gate_powers(const dyn_mat<Scalar>& A, idx k) {
+    std::vector<dyn_mat<Scalar>> result;
+    result.reserve(k);
+    if (k > 0)
+        result.push_back(A);
+    for (idx i = 1; i < k; ++i)
+        result.push_back((result.back() * A).eval());
+    return result;
+}
+
+// true if the square matrix A has no non-zero off-diagonal entry, the check
+// is exact, as the diagonal gates are constructed with exact zeros
+template <typename Scalar>
+bool is_diagonal(const dyn_mat<Scalar>& A) noexcept {
+    for (idx j = 0; j < static_cast<idx>(A.cols()); ++j)
+        for (idx i = 0; i < static_cast<idx>(A.rows()); ++i)
+            if (i != j && A(i, j) != Scalar{0})
+                return false;
+    return true;
+}
+
+// applies in place the (controlled) diagonal gate to the part target of the
+// state vector psi, i.e. the amplitudes of the basis state |m> of target are
+// multiplied by diags[p](m) on the block in which all control subsystems are
+// in the state |p + 1>; diags is the table of the diagonals of the powers of
+// the gate, same as for apply_ctrl_ket_inplace(); one elementwise
+// multiplication, no gather
+// no error checks, the arguments are assumed to have been validated by the
+// caller
+template <typename Derived>
+void apply_diag_ket_inplace(
+    Eigen::MatrixBase<Derived>& psi,
+    const std::vector<dyn_col_vect<typename Derived::Scalar>>& diags,
+    const std::vector<idx>& ctrl, const std::vector<idx>& target,
+    const std::vector<idx>& dims) {
+    using Scalar = typename Derived::Scalar;
+    idx n = dims.size();
+    idx ctrlsize = ctrl.size();
+    idx targetsize = target.size();
+    idx DA = static_cast<idx>(diags[0].size());
+
+    // qubits, the fixed (control and target) bits are inserted into a
+    // running index and the amplitudes are visited in unit-stride runs, same
+    // as for apply_qubit_ket_inplace_()
+    if (n < std::numeric_limits<idx>::digits &&
+        std::all_of(std::begin(dims), std::end(dims),
+                    [](idx dim) { return dim == 2; })) {
+        // maximum length of a unit-stride run
+        constexpr idx max_run = 64;
+
+        std::vector<idx> offsetsA(DA, 0);
+        for (idx m = 0; m < DA; ++m)
+            for (idx k = 0; k < targetsize; ++k)
+                if ((m >> (targetsize - k - 1)) & 1)
+                    offsetsA[m] |= static_cast<idx>(1) << (n - target[k] - 1);
+
+        std::vector<idx> fixed_strides;
+        idx ctrl_mask = 0;
+        for (idx k = 0; k < ctrlsize; ++k) {
+            idx stride = static_cast<idx>(1) << (n - ctrl[k] - 1);
+            fixed_strides.push_back(stride);
+            ctrl_mask |= stride;
+        }
+        for (idx k = 0; k < targetsize; ++k)
+            fixed_strides.push_back(static_cast<idx>(1)
+                                    << (n - target[k] - 1));
+        std::sort(std::begin(fixed_strides), std::end(fixed_strides));
+        idx nfixed = fixed_strides.size();
+
+        idx D_free = static_cast<idx>(1) << (n - nfixed);
+        idx run = std::min(fixed_strides[0], max_run);
+        idx nruns = D_free / run;
+        Scalar* data = psi.derived().data();
+        const Scalar* diag = diags[0].data();
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+        for (idx r = 0; r < nruns; ++r) {
+            // insert the fixed bits, set all control bits
+            idx start = r * run;
+            for (idx k = 0; k < nfixed; ++k)
+                start += start & ~(fixed_strides[k] - 1);
+            start |= ctrl_mask;
+
+            for (idx m = 0; m < DA; ++m)
+                scale_run_(data + start + offsetsA[m], run, diag[m]);
+        }
+        return;
+    }
+
+    // blocks over the subsystems that are neither control nor target, and
+    // offsets of the target block, one for each basis state of the target
+    std::vector<idx> ctrlgate = ctrl;
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    IndexPlan plan{dims, ctrlgate};
+    std::vector<idx> offsetsA = plan.offsets(target);
+
+    // offsets of the control blocks, the identity (power 0) is skipped
+    idx npowers = 1;
+    std::vector<idx> offsets_ctrl(1, 0);
+    if (ctrlsize > 0) {
+        idx d = dims[ctrl[0]];
+        idx stride_ctrl = 0;
+        for (idx k = 0; k < ctrlsize; ++k)
+            stride_ctrl += plan.stride(ctrl[k]);
+        npowers = d - 1;
+        offsets_ctrl.resize(npowers);
+        for (idx k = 0; k < npowers; ++k)
+            offsets_ctrl[k] = (k + 1) * stride_ctrl;
+    }
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    plan.for_each([&](idx, idx base) {
+        for (idx p = 0; p < npowers; ++p) {
+            Scalar* start = psi.derived().data() + base + offsets_ctrl[p];
+            const Scalar* diag = diags[p].data();
+            for (idx m = 0; m < DA; ++m)
+                start[offsetsA[m]] *= diag[m];
+        }
+    });
+}
+
+// applies in place the (controlled) gate A to the part target of the state
+// vector psi, i.e. A^k is applied on the block in which all control
+// subsystems are in the state |k>; with no control A is applied everywhere
+// Ai is the table of powers A^1, ..., A^(d-1), d being the dimension of the
+// control subsystems, only A^1 is needed when there are no controls
+// no error checks, the arguments are assumed to have been validated by the
+// caller (qpp::applyCTRL() or qpp::QCircuit)
+template <typename Derived>
+void apply_ctrl_ket_inplace(
+    Eigen::MatrixBase<Derived>& psi,
+    const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+    const std::vector<idx>& ctrl, const std::vector<idx>& target,
+    const std::vector<idx>& dims) {
+    using Scalar = typename Derived::Scalar;
+    idx n = dims.size();
+    idx ctrlsize = ctrl.size();
+    idx targetsize = target.size();
+    idx DA = static_cast<idx>(Ai[0].rows());
+
+    // diagonal gates, the powers of a diagonal matrix are diagonal
+    if (is_diagonal(Ai[0])) {
+        std::vector<dyn_col_vect<Scalar>> diags;
+        diags.reserve(Ai.size());
+        for (auto&& elem : Ai)
+            diags.emplace_back(elem.diagonal());
+        apply_diag_ket_inplace(psi, diags, ctrl, target, dims);
+        return;
+    }
+
+    // dedicated qubit kernels for one and two target gates
+    if (targetsize <= 2 && n < std::numeric_limits<idx>::digits &&
+        std::all_of(std::begin(dims), std::end(dims),
+                    [](idx dim) { return dim == 2; })) {
+        if (targetsize == 1)
+            apply_qubit_ket_inplace_<1>(psi, Ai[0], ctrl, target, n);
+        else
+            apply_qubit_ket_inplace_<2>(psi, Ai[0], ctrl, target, n);
+        return;
+    }
+
+    // blocks over the subsystems that are neither control nor target, and
+    // offsets of the target block, one for each basis state of the target
+    std::vector<idx> ctrlgate = ctrl;
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    IndexPlan plan{dims, ctrlgate};
+    std::vector<idx> offsetsA = plan.offsets(target);
+
+    // offsets of the control blocks on which the powers of A act, A^0 is
+    // the identity and is skipped
+    idx npowers = 1;
+    std::vector<idx> offsets_ctrl(1, 0);
+    if (ctrlsize > 0) {
+        idx d = dims[ctrl[0]];
+        idx stride_ctrl = 0;
+        for (idx k = 0; k < ctrlsize; ++k)
+            stride_ctrl += plan.stride(ctrl[k]);
+        npowers = d - 1;
+        offsets_ctrl.resize(npowers);
+        for (idx k = 0; k < npowers; ++k)
+            offsets_ctrl[k] = (k + 1) * stride_ctrl;
+    }
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // per-thread scratch, holds one target block of amplitudes
+        dyn_col_vect<Scalar> block(DA);
+
+        plan.for_each([&](idx, idx base) {
+            for (idx p = 0; p < npowers; ++p) {
+                idx start = base + offsets_ctrl[p];
+                // gather
+                for (idx m = 0; m < DA; ++m)
+                    block(m) = psi(start + offsetsA[m]);
+                // multiply and scatter
+                for (idx m = 0; m < DA; ++m) {
+                    Scalar coeff = 0;
+                    for (idx j = 0; j < DA; ++j)
+                        coeff += Ai[p](m, j) * block(j);
+                    psi(start + offsetsA[m]) = coeff;
+                }
+            }
+        });
+    }
+}
+
+// same as above, computes the powers of A on the fly
+template <typename Derived>
+void apply_ctrl_ket_inplace(Eigen::MatrixBase<Derived>& psi,
+                            const dyn_mat<typename Derived::Scalar>& A,
+                            const std::vector<idx>& ctrl,
+                            const std::vector<idx>& target,
+                            const std::vector<idx>& dims) {
+    idx npowers = ctrl.empty() ? 1 : std::max(dims[ctrl[0]] - 1, idx{1});
+    apply_ctrl_ket_inplace(psi, gate_powers(A, npowers), ctrl, target, dims);
+}
+
+// the powers perm, perm^2, ..., perm^k of the permutation perm, where perm
+// maps the basis state |m> to |perm[m]>
+inline std::vector<std::vector<idx>> perm_powers(const std::vector<idx>& perm,
+                                                 idx k) {
+    std::vector<std::vector<idx>> result;
+    result.reserve(k);
+    if (k > 0)
+        result.push_back(perm);
+    for (idx i = 1; i < k; ++i) {
+        std::vector<idx> next(perm.size());
+        for (idx m = 0; m < perm.size(); ++m)
+            next[m] = perm[result.back()[m]];
+        result.push_back(std::move(next));
+    }
+    return result;
+}
+
+// applies in place the (controlled) permutation gate to the part target of
+// the state vector psi, i.e. the basis state |m> of target is mapped to
+// |perms[p][m]> on the block in which all control subsystems are in the
+// state |p + 1>; perms is the table of powers of the permutation, same as
+// for apply_ctrl_ket_inplace(); one gather and one scatter per block, no
+// arithmetic
+// no error checks, the arguments are assumed to have been validated by the
+// caller (qpp::applyCTRL() or qpp::QCircuit)
+template <typename Derived>
+void apply_perm_ket_inplace(Eigen::MatrixBase<Derived>& psi,
+                            const std::vector<std::vector<idx>>& perms,
+                            const std::vector<idx>& ctrl,
+                            const std::vector<idx>& target,
+                            const std::vector<idx>& dims) {
+    using Scalar = typename Derived::Scalar;
+    idx ctrlsize = ctrl.size();
+    idx DA = perms[0].size();
+
+    // blocks over the subsystems that are neither control nor target, and
+    // offsets of the target block, one for each basis state of the target
+    std::vector<idx> ctrlgate = ctrl;
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    IndexPlan plan{dims, ctrlgate};
+    std::vector<idx> offsetsA = plan.offsets(target);
+
+    // offsets of the control blocks, the identity (perm^0) is skipped
+    idx npowers = 1;
+    std::vector<idx> offsets_ctrl(1, 0);
+    if (ctrlsize > 0) {
+        idx d = dims[ctrl[0]];
+        idx stride_ctrl = 0;
+        for (idx k = 0; k < ctrlsize; ++k)
+            stride_ctrl += plan.stride(ctrl[k]);
+        npowers = d - 1;
+        offsets_ctrl.resize(npowers);
+        for (idx k = 0; k < npowers; ++k)
+            offsets_ctrl[k] = (k + 1) * stride_ctrl;
+    }
+
+    // the offsets the amplitudes are scattered to, one table per power
+    std::vector<std::vector<idx>> offsets_perm(npowers, std::vector<idx>(DA));
+    for (idx p = 0; p < npowers; ++p)
+        for (idx m = 0; m < DA; ++m)
+            offsets_perm[p][m] = offsetsA[perms[p][m]];
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // per-thread scratch, holds one target block of amplitudes
+        std::vector<Scalar> block(DA);
+
+        plan.for_each([&](idx, idx base) {
+            for (idx p = 0; p < npowers; ++p) {
+                Scalar* start = psi.derived().data() + base + offsets_ctrl[p];
+                const idx* scatter = offsets_perm[p].data();
+                for (idx m = 0; m < DA; ++m)
+                    block[m] = start[offsetsA[m]];
+                for (idx m = 0; m < DA; ++m)
+                    start[scatter[m]] = block[m];
+            }
+        });
+    }
+}
+
+// same as above, computes the powers of perm on the fly
+template <typename Derived>
+void apply_perm_ket_inplace(Eigen::MatrixBase<Derived>& psi,
+                            const std::vector<idx>& perm,
+                            const std::vector<idx>& ctrl,
+                            const std::vector<idx>& target,
+                            const std::vector<idx>& dims) {
+    idx npowers = ctrl.empty() ? 1 : std::max(dims[ctrl[0]] - 1, idx{1});
+    apply_perm_ket_inplace(psi, perm_powers(perm, npowers), ctrl, target,
+                           dims);
+}
+
+// complex product without the NaN/Inf recovery branch of operator*(), see
+// qubit_run_()
+template <typename T>
+inline std::complex<T> cmul_(const std::complex<T>& a,
+                             const std::complex<T>& b) noexcept {
+    return {a.real() * b.real() - a.imag() * b.imag(),
+            a.real() * b.imag() + a.imag() * b.real()};
+}
+
+// swaps in place the subsystems a and b, of equal dimension, of the state
+// vector psi; one strided pass, no multi-index arithmetic
+template <typename Derived>
+void swap_subsys_ket_(Eigen::MatrixBase<Derived>& psi, idx a, idx b,
+                      const std::vector<idx>& dims) {
+    if (a > b)
+        std::swap(a, b);
+    idx d = dims[a];
+    idx sb = 1;
+    for (idx k = b + 1; k < dims.size(); ++k)
+        sb *= dims[k];
+    idx sa = sb;
+    for (idx k = a + 1; k <= b; ++k)
+        sa *= dims[k];
+    // psi index = hi * (d * sa) + u * sa + mid * (d * sb) + v * sb + lo
+    idx nhi = static_cast<idx>(psi.size()) / (d * sa);
+    idx nmid = sa / (d * sb);
+
+    auto* p = psi.derived().data();
+#ifdef WITH_OPENMP_
+#pragma omp parallel for collapse(2)
+#endif // WITH_OPENMP_
+    for (idx hi = 0; hi < nhi; ++hi)
+        for (idx mid = 0; mid < nmid; ++mid) {
+            idx base = hi * d * sa + mid * d * sb;
+            for (idx u = 0; u < d; ++u)
+                for (idx v = u + 1; v < d; ++v) {
+                    auto* x = p + base + u * sa + v * sb;
+                    auto* y = p + base + v * sa + u * sb;
+                    for (idx lo = 0; lo < sb; ++lo)
+                        std::swap(x[lo], y[lo]);
+                }
+        }
+}
+
+// one stage of the quantum Fourier transform, i.e. the Fourier gate on
+// target[i] fused with all the controlled phase gates that act on target[i]
+// in the textbook circuit; the phase is exp(2 pi i y K / d^(k - i)), with y
+// the digit of target[i] and K = sum_{l > i} x_l d^(k - 1 - l) formed by the
+// digits of the later target subsystems, split as K = Khi d^m + Klo so that
+// it is looked up in two tables of about sqrt(d^(k - i)) entries; in the
+// inverse stage the conjugate phase is applied before the inverse Fourier
+// gate, sign is -1 for the inverse (or the complex conjugate) transform
+template <typename Derived>
+void qft_stage_(Eigen::MatrixBase<Derived>& psi,
+                const std::vector<idx>& target, idx i,
+                const std::vector<idx>& dims, bool inverse, double sign) {
+    using Scalar = typename Derived::Scalar;
+    idx n = dims.size();
+    idx k = target.size();
+    idx t = target[i];
+    idx d = dims[t];
+
+    // strides of each subsystem, standard lexicographical order
+    std::vector<idx> strides(n);
+    strides[n - 1] = 1;
+    for (idx q = n - 1; q > 0; --q)
+        strides[q - 1] = strides[q] * dims[q];
+    idx st = strides[t];
+
+    // weights of the digits of the later target subsystems in Klo and Khi
+    idx L = k - i - 1;
+    idx m = L / 2;
+    std::vector<idx> wlo(n, 0), whi(n, 0);
+    idx nlo = 1, nhi = 1;
+    for (idx e = 0; e < L; ++e) {
+        if (e < m) {
+            wlo[target[k - 1 - e]] = nlo;
+            nlo *= d;
+        } else {
+            whi[target[k - 1 - e]] = nhi;
+            nhi *= d;
+        }
+    }
+    double N = static_cast<double>(nlo) * static_cast<double>(nhi * d);
+    std::vector<Scalar> tab_lo(nlo), tab_hi(nhi);
+    for (idx j = 0; j < nlo; ++j)
+        tab_lo[j] = static_cast<Scalar>(
+            std::polar(1.0, sign * 2 * pi * static_cast<double>(j) / N));
+    for (idx j = 0; j < nhi; ++j)
+        tab_hi[j] = static_cast<Scalar>(std::polar(
+            1.0, sign * 2 * pi * static_cast<double>(j * nlo) / N));
+
+    // the d x d Fourier gate (or its conjugate), row-major
+    std::vector<Scalar> F(d * d);
+    for (idx y = 0; y < d; ++y)
+        for (idx x = 0; x < d; ++x)
+            F[y * d + x] = static_cast<Scalar>(std::polar(
+                1 / std::sqrt(static_cast<double>(d)),
+                sign * 2 * pi * static_cast<double>((x * y) % d) / d));
+    auto isq = static_cast<typename Derived::RealScalar>(1 / std::sqrt(2.0));
+
+    // all the other subsystems, visited with an odometer
+    idx Cdims_bar[maxn];
+    idx Cstrides_bar[maxn];
+    idx Cwlo_bar[maxn];
+    idx Cwhi_bar[maxn];
+    idx n_bar = 0;
+    for (idx q = 0; q < n; ++q)
+        if (q != t) {
+            Cdims_bar[n_bar] = dims[q];
+            Cstrides_bar[n_bar] = strides[q];
+            Cwlo_bar[n_bar] = wlo[q];
+            Cwhi_bar[n_bar++] = whi[q];
+        }
+    idx G = static_cast<idx>(psi.size()) / d;
+    const idx chunk = 1024;
+    idx nchunks = (G + chunk - 1) / chunk;
+
+    Scalar* p = psi.derived().data();
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // per-thread scratch
+        std::vector<Scalar> v(d);
+        idx Cmidx_bar[maxn];
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < nchunks; ++c) {
+            idx g = c * chunk;
+            idx g_end = std::min(g + chunk, G);
+            n2multiidx(g, n_bar, Cdims_bar, Cmidx_bar);
+            idx base = 0, klo = 0, khi = 0;
+            for (idx q = 0; q < n_bar; ++q) {
+                base += Cmidx_bar[q] * Cstrides_bar[q];
+                klo += Cmidx_bar[q] * Cwlo_bar[q];
+                khi += Cmidx_bar[q] * Cwhi_bar[q];
+            }
+
+            for (; g < g_end; ++g) {
+                Scalar phase = cmul_(tab_hi[khi], tab_lo[klo]);
+                Scalar* start = p + base;
+                if (d == 2) {
+                    Scalar a = start[0];
+                    Scalar b = start[st];
+                    if (inverse)
+                        b = cmul_(b, phase);
+                    start[0] = (a + b) * isq;
+                    start[st] = (a - b) * isq;
+                    if (!inverse)
+                        start[st] = cmul_(start[st], phase);
+                } else {
+                    Scalar pw = 1;
+                    for (idx x = 0; x < d; ++x) {
+                        v[x] = start[x * st];
+                        if (inverse) {
+                            v[x] = cmul_(v[x], pw);
+                            pw = cmul_(pw, phase);
+                        }
+                    }
+                    pw = 1;
+                    for (idx y = 0; y < d; ++y) {
+                        Scalar w = 0;
+                        for (idx x = 0; x < d; ++x)
+                            w += cmul_(F[y * d + x], v[x]);
+                        if (!inverse) {
+                            w = cmul_(w, pw);
+                            pw = cmul_(pw, phase);
+                        }
+                        start[y * st] = w;
+                    }
+                }
+
+                // next group, the last digit runs fastest
+                for (idx q = n_bar; q-- > 0;) {
+                    if (++Cmidx_bar[q] < Cdims_bar[q]) {
+                        base += Cstrides_bar[q];
+                        klo += Cwlo_bar[q];
+                        khi += Cwhi_bar[q];
+                        break;
+                    }
+                    Cmidx_bar[q] = 0;
+                    base -= (Cdims_bar[q] - 1) * Cstrides_bar[q];
+                    klo -= (Cdims_bar[q] - 1) * Cwlo_bar[q];
+                    khi -= (Cdims_bar[q] - 1) * Cwhi_bar[q];
+                }
+            }
+        }
+    }
+}
+
+// applies in place the quantum Fourier transform, or its inverse, to the part
+// target of the state vector psi, all target subsystems having the same
+// dimension; with conj set the entrywise complex conjugate of the transform
+// is applied instead (used on the column subsystems of density matrices)
+// one pass per target subsystem instead of the O(k^2) gates of the circuit,
+// plus one pass per pair of subsystems swapped at the end (at the beginning
+// for the inverse)
+// no error checks, the arguments are assumed to have been validated by the
+// caller (qpp::applyQFT(), qpp::applyTFQ() or qpp::QEngine)
+template <typename Derived>
+void apply_qft_ket_inplace(Eigen::MatrixBase<Derived>& psi,
+                           const std::vector<idx>& target,
+                           const std::vector<idx>& dims, bool inverse,
+                           bool swap, bool conj = false) {
+    idx k = target.size();
+    double sign = (inverse != conj) ? -1 : 1;
+
+    if (swap && inverse)
+        for (idx i = 0; i < k / 2; ++i)
+            swap_subsys_ket_(psi, target[i], target[k - 1 - i], dims);
+    for (idx s = 0; s < k; ++s)
+        qft_stage_(psi, target, inverse ? k - 1 - s : s, dims, inverse, sign);
+    if (swap && !inverse)
+        for (idx i = 0; i < k / 2; ++i)
+            swap_subsys_ket_(psi, target[i], target[k - 1 - i], dims);
+}
+
+// applies in place the sparse gate A to the part target of the state vector
+// psi, one sparse matrix-vector product per target block, so that the cost is
+// proportional to the number of non-zero entries of A
+// no error checks, the arguments are assumed to have been validated by the
+// caller (qpp::apply())
+template <typename Derived>
+void apply_sparse_ket_inplace(
+    Eigen::MatrixBase<Derived>& psi,
+    const dyn_sparse_mat<typename Derived::Scalar>& A,
+    const std::vector<idx>& target, const std::vector<idx>& dims) {
+    using Scalar = typename Derived::Scalar;
+    idx DA = static_cast<idx>(A.rows());
+
+    // blocks over the subsystems that are not target, and offsets of the
+    // target block
+    IndexPlan plan{dims, target};
+    std::vector<idx> offsetsA = plan.offsets(target);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // per-thread scratch, holds one target block of amplitudes
+        dyn_col_vect<Scalar> block_in(DA), block_out(DA);
+
+        plan.for_each([&](idx, idx base) {
+            Scalar* start = psi.derived().data() + base;
+            for (idx m = 0; m < DA; ++m)
+                block_in(m) = start[offsetsA[m]];
+            block_out.noalias() = A * block_in;
+            for (idx m = 0; m < DA; ++m)
+                start[offsetsA[m]] = block_out(m);
+        });
+    }
+}
+
+// permutes the subsystems of the state vector read from in, of dimensions
+// dims, into out, so that the subsystem perm[k] becomes the k-th one; the
+// output subsystems that are consecutive in the input as well are merged
+// (up to the tile side), then the state is moved in tiles of about 32 x 32
+// amplitudes (tiled transposition), spanned by the trailing output and the
+// trailing input subsystems, so that both the reads and the writes stay
+// within the cache
+// in and out must not overlap; no error checks, the arguments are assumed to
+// have been validated by the caller (qpp::syspermute())
+template <typename Scalar>
+void syspermute_ket(const Scalar* in, Scalar* out, const std::vector<idx>& perm,
+                    const std::vector<idx>& dims) {
+    idx n = dims.size();
+    idx D = 1;
+    for (idx q = 0; q < n; ++q)
+        D *= dims[q];
+
+    // strides of each input subsystem, standard lexicographical order
+    std::vector<idx> strides(n);
+    strides[n - 1] = 1;
+    for (idx q = n - 1; q > 0; --q)
+        strides[q - 1] = strides[q] * dims[q];
+
+    // tile side, see below
+    const idx T = 32;
+
+    // merged output subsystems, with their input and output strides; merged
+    // subsystems are kept within the tile side, so that no tile grows to the
+    // size of the state
+    bool identity = true;
+    for (idx k = 0; k < n; ++k)
+        if (perm[k] != k)
+            identity = false;
+    if (identity) {
+        std::copy(in, in + D, out);
+        return;
+    }
+    std::vector<idx> mdims, mstrides_in, mstrides_out;
+    for (idx k = 0; k < n; ++k) {
+        if (k > 0 && perm[k] == perm[k - 1] + 1 &&
+            mdims.back() * dims[perm[k]] <= T) {
+            mdims.back() *= dims[perm[k]];
+            mstrides_in.back() = strides[perm[k]];
+        } else {
+            mdims.push_back(dims[perm[k]]);
+            mstrides_in.push_back(strides[perm[k]]);
+        }
+    }
+    idx m = mdims.size();
+    mstrides_out.resize(m);
+    mstrides_out[m - 1] = 1;
+    for (idx k = m - 1; k > 0; --k)
+        mstrides_out[k - 1] = mstrides_out[k] * mdims[k];
+
+    // the tile is spanned by the group A of trailing output subsystems and
+    // by the group B of trailing input subsystems
+    std::vector<bool> in_tile(m, false);
+    std::vector<idx> groupA, groupB;
+    idx NA = 1;
+    for (idx k = m; k-- > 0 && NA < T;) {
+        groupA.push_back(k);
+        in_tile[k] = true;
+        NA *= mdims[k];
+    }
+    std::vector<idx> by_stride_in;
+    for (idx k = 0; k < m; ++k)
+        if (!in_tile[k])
+            by_stride_in.push_back(k);
+    std::sort(std::begin(by_stride_in), std::end(by_stride_in),
+              [&mstrides_in](idx a, idx b) {
+                  return mstrides_in[a] < mstrides_in[b];
+              });
+    idx NB = 1;
+    for (idx i = 0; i < by_stride_in.size() && NB < T; ++i) {
+        groupB.push_back(by_stride_in[i]);
+        in_tile[by_stride_in[i]] = true;
+        NB *= mdims[by_stride_in[i]];
+    }
+
+    // input and output offsets within a tile, for each group
+    auto offsets = [&](const std::vector<idx>& group, idx N,
+                       std::vector<idx>& off_in, std::vector<idx>& off_out) {
+        off_in.assign(N, 0);
+        off_out.assign(N, 0);
+        for (idx i = 0; i < N; ++i) {
+            idx r = i;
+            for (idx g = 0; g < group.size(); ++g) {
+                idx k = group[g];
+                off_in[i] += (r % mdims[k]) * mstrides_in[k];
+                off_out[i] += (r % mdims[k]) * mstrides_out[k];
+                r /= mdims[k];
+            }
+        }
+    };
+    std::vector<idx> inA, outA, inB, outB;
+    offsets(groupA, NA, inA, outA);
+    offsets(groupB, NB, inB, outB);
+
+    // all the other subsystems, one tile per multi-index
+    idx Cdims_bar[maxn];
+    idx Cstrides_in_bar[maxn];
+    idx Cstrides_out_bar[maxn];
+    idx n_bar = 0;
+    for (idx k = 0; k < m; ++k)
+        if (!in_tile[k]) {
+            Cdims_bar[n_bar] = mdims[k];
+            Cstrides_in_bar[n_bar] = mstrides_in[k];
+            Cstrides_out_bar[n_bar++] = mstrides_out[k];
+        }
+    idx ntiles = D / (NA * NB);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx t = 0; t < ntiles; ++t) {
+        idx Cmidx_bar[maxn];
+        n2multiidx(t, n_bar, Cdims_bar, Cmidx_bar);
+        idx base_in = 0, base_out = 0;
+        for (idx k = 0; k < n_bar; ++k) {
+            base_in += Cmidx_bar[k] * Cstrides_in_bar[k];
+            base_out += Cmidx_bar[k] * Cstrides_out_bar[k];
+        }
+        for (idx b = 0; b < NB; ++b) {
+            const Scalar* src = in + base_in + inB[b];
+            Scalar* dst = out + base_out + outB[b];
+            for (idx a = 0; a < NA; ++a)
+                dst[outA[a]] = src[inA[a]];
+        }
+    }
+}
+
+// element accessor of the read-only view returned by qpp::syspermute_view(),
+// the entry (i, j) of the view is the entry (src(i), src(j)) of the viewed
+// state, src mapping the permuted basis state index to the original one
+template <typename Scalar>
+class PermutedView {
+    const Scalar* data_;      // viewed state, column-major
+    idx rows_;                // number of rows of the viewed state
+    bool is_ket_;             // the viewed state is a column vector
+    std::vector<idx> dims_;   // permuted dimensions
+    std::vector<idx> strides_; // original strides of the permuted subsystems
+
+    idx src_(idx i) const {
+        idx result = 0;
+        for (idx k = dims_.size(); k-- > 0;) {
+            result += (i % dims_[k]) * strides_[k];
+            i /= dims_[k];
+        }
+        return result;
+    }
+
+  public:
+    PermutedView(const Scalar* data, idx rows, bool is_ket,
+                 const std::vector<idx>& perm, const std::vector<idx>& dims)
+        : data_{data}, rows_{rows}, is_ket_{is_ket}, dims_(perm.size()),
+          strides_(perm.size()) {
+        idx n = dims.size();
+        std::vector<idx> strides(n);
+        strides[n - 1] = 1;
+        for (idx q = n - 1; q > 0; --q)
+            strides[q - 1] = strides[q] * dims[q];
+        for (idx k = 0; k < n; ++k) {
+            dims_[k] = dims[perm[k]];
+            strides_[k] = strides[perm[k]];
+        }
+    }
+    PermutedView(const PermutedView&) = default;
+    PermutedView& operator=(const PermutedView&) = default;
+
+    Scalar operator()(Eigen::Index i, Eigen::Index j) const {
+        idx row = src_(static_cast<idx>(i));
+        idx col = is_ket_ ? 0 : src_(static_cast<idx>(j));
+        return data_[col * rows_ + row];
+    }
+};
+
+// reduced density matrix of the part target of the state vector psi, i.e.
+// M * M^dagger, where the columns of the DA x D_bar matrix M are the target
+// blocks of amplitudes, computed with matrix-matrix products (GEMM); when
+// the target subsystems are the leading or the trailing ones, in order, M is
+// psi itself (read as a row-major, respectively column-major, matrix),
+// otherwise M is gathered in chunks of columns, each thread accumulating its
+// own partial product; it is not normalized by the norm of psi
+template <typename Derived>
+dyn_mat<typename Derived::Scalar>
+reduced_rho_ket(const Eigen::MatrixBase<Derived>& psi,
+                const std::vector<idx>& target, const std::vector<idx>& dims) {
+    using Scalar = typename Derived::Scalar;
+    const Derived& rpsi = psi.derived();
+    idx n = dims.size();
+    idx targetsize = target.size();
+
+    idx DA = 1;
+    for (idx k = 0; k < targetsize; ++k)
+        DA *= dims[target[k]];
+    idx D_bar = static_cast<idx>(rpsi.size()) / DA;
+
+    // psi read in place
+    bool leading = true;
+    bool trailing = true;
+    for (idx k = 0; k < targetsize; ++k) {
+        if (target[k] != k)
+            leading = false;
+        if (target[k] != n - targetsize + k)
+            trailing = false;
+    }
+    if (leading) {
+        Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic,
+                                       Eigen::RowMajor>>
+            M(rpsi.data(), DA, D_bar);
+        return M * M.adjoint();
+    }
+    if (trailing) {
+        Eigen::Map<const dyn_mat<Scalar>> M(rpsi.data(), DA, D_bar);
+        return M * M.adjoint();
+    }
+
+    // columns of M over the subsystems that are not traced out, and
+    // offsets of the target block
+    IndexPlan plan{dims, target};
+    std::vector<idx> offsetsA = plan.offsets(target);
+
+    // columns of M per product
+    const idx chunk = 256;
+    idx nchunks = (D_bar + chunk - 1) / chunk;
+
+    dyn_mat<Scalar> result = dyn_mat<Scalar>::Zero(DA, DA);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // per-thread partial product and chunk of M
+        dyn_mat<Scalar> partial = dyn_mat<Scalar>::Zero(DA, DA);
+        dyn_mat<Scalar> M(DA, chunk);
+        idx Cmidx_bar[maxn];
+
+#ifdef WITH_OPENMP_
+#pragma omp for nowait
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < nchunks; ++c) {
+            idx cols = std::min(chunk, D_bar - c * chunk);
+            idx base = plan.first(c * chunk, Cmidx_bar);
+            for (idx j = 0; j < cols; ++j) {
+                for (idx m = 0; m < DA; ++m)
+                    M(m, j) = rpsi(base + offsetsA[m]);
+                base = plan.next(Cmidx_bar, base);
+            }
+            partial.noalias() +=
+                M.leftCols(cols) * M.leftCols(cols).adjoint();
+        }
+#ifdef WITH_OPENMP_
+#pragma omp critical
+#endif // WITH_OPENMP_
+        { result += partial; }
+    }
+
+    return result;
+}
+
+// normalizes in place the state vector psi, the squared norm is accumulated
+// in double precision whatever the precision of psi, so that the norm of
+// single precision states does not drift with the number of amplitudes
+template <typename Derived>
+void renormalize_ket(Eigen::MatrixBase<Derived>& psi) {
+    idx D = static_cast<idx>(psi.size());
+    const typename Derived::Scalar* p = psi.derived().data();
+    double norm2 = 0;
+#ifdef WITH_OPENMP_
+#pragma omp parallel for reduction(+ : norm2)
+#endif // WITH_OPENMP_
+    for (idx i = 0; i < D; ++i)
+        norm2 += static_cast<double>(std::norm(p[i]));
+
+    if (norm2 > 0)
+        psi *= static_cast<typename Derived::RealScalar>(1 / std::sqrt(norm2));
+}
+
+// marginal probabilities of the outcomes of the measurement of the subsystem
+// target of the state vector psi in the computational basis, computed in one
+// strided pass; they are not normalized by the norm of psi
+template <typename Derived>
+std::vector<double> marginal_probs_ket(const Eigen::MatrixBase<Derived>& psi,
+                                       idx target,
+                                       const std::vector<idx>& dims) {
+    idx D = static_cast<idx>(psi.size());
+    idx Dt = dims[target];
+    idx stride = 1;
+    for (idx k = target + 1; k < dims.size(); ++k)
+        stride *= dims[k];
+    idx nblocks = D / (Dt * stride);
+
+    // one pass over (b, k, j), accumulated in per-thread partial sums
+    std::vector<double> result(Dt, 0);
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        std::vector<double> partial(Dt, 0);
+#ifdef WITH_OPENMP_
+#pragma omp for collapse(3)
+#endif // WITH_OPENMP_
+        for (idx b = 0; b < nblocks; ++b)
+            for (idx k = 0; k < Dt; ++k)
+                for (idx j = 0; j < stride; ++j)
+                    partial[k] += std::norm(psi((b * Dt + k) * stride + j));
+#ifdef WITH_OPENMP_
+#pragma omp critical
+#endif // WITH_OPENMP_
+        {
+            for (idx k = 0; k < Dt; ++k)
+                result[k] += partial[k];
+        }
+    }
+
+    return result;
+}
+
+// the state vector psi projected on the basis state |k> of the subsystem
+// target, with the subsystem target removed and the amplitudes multiplied by
+// scale; no intermediate state of full size is constructed
+template <typename Derived>
+dyn_col_vect<typename Derived::Scalar>
+collapse_ket(const Eigen::MatrixBase<Derived>& psi, idx target, idx k,
+             const std::vector<idx>& dims, double scale) {
+    idx D = static_cast<idx>(psi.size());
+    idx Dt = dims[target];
+    idx stride = 1;
+    for (idx i = target + 1; i < dims.size(); ++i)
+        stride *= dims[i];
+    idx nblocks = D / (Dt * stride);
+
+    auto rscale = static_cast<typename Derived::RealScalar>(scale);
+    dyn_col_vect<typename Derived::Scalar> result(nblocks * stride);
+#ifdef WITH_OPENMP_
+#pragma omp parallel for collapse(2)
+#endif // WITH_OPENMP_
+    for (idx b = 0; b < nblocks; ++b)
+        for (idx j = 0; j < stride; ++j)
+            result(b * stride + j) = psi((b * Dt + k) * stride + j) * rscale;
+
+    return result;
+}
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_KERNELS_H_ */
@@ -130,6 +130,15 @@ bool check_matching_sizes(const T1& lhs, const T2& rhs) noexcept {
     return lhs.size() == rhs.size();
 }
 
+// check that a gate over the field GScalar can be applied on a state over
+// the field SScalar, i.e. either the same field, or complex fields of
+// different precisions, the gate being converted to the precision of the state
+template <typename SScalar, typename GScalar>
+bool check_gate_scalar() noexcept {
+    return std::is_same<SScalar, GScalar>::value ||
+           (is_complex<SScalar>::value && is_complex<GScalar>::value);
+}
+
 // check that dims is a valid dimension vector
 inline bool check_dims(const std::vector<idx>& dims) {
     if (dims.size() == 0)
@@ -264,11 +273,15 @@ inline bool check_perm(const std::vector<idx>& perm) {
     if (perm.size() == 0)
         return false;
 
-    std::vector<idx> ordered(perm.size());
-    std::iota(std::begin(ordered), std::end(ordered), 0);
+    // linear time, permutations of basis states may be large
+    std::vector<bool> seen(perm.size(), false);
+    for (auto&& elem : perm) {
+        if (elem >= perm.size() || seen[elem])
+            return false;
+        seen[elem] = true;
+    }
 
-    return std::is_permutation(std::begin(ordered), std::end(ordered),
-                               std::begin(perm));
+    return true;
 }
 
 // Kronecker product of 2 matrices, preserve return type
@@ -391,6 +404,127 @@ inline idx get_dim_subsys(idx sz, idx N) {
     return static_cast<idx>(std::llround(std::pow(sz, 1. / N)));
 }
 
+// number of bits set in x
+inline idx popcount(unsigned long long x) noexcept {
+#if (__GNUC__ || __clang__)
+    return static_cast<idx>(__builtin_popcountll(x));
+#else
+    idx result = 0;
+    for (; x; x &= x - 1)
+        ++result;
+    return result;
+#endif
+}
+
+// CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) of len bytes,
+// continuing from crc; slicing-by-8, independent of the byte order of the
+// machine
+inline std::uint32_t crc32(const void* data, std::size_t len,
+                           std::uint32_t crc = 0) {
+    // table[s][b] is the CRC of the byte b followed by s zero bytes
+    static const std::vector<std::uint32_t> table = [] {
+        std::vector<std::uint32_t> result(8 * 256);
+        for (std::uint32_t b = 0; b < 256; ++b) {
+            std::uint32_t c = b;
+            for (idx k = 0; k < 8; ++k)
+                c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+            result[b] = c;
+        }
+        for (idx s = 1; s < 8; ++s)
+            for (idx b = 0; b < 256; ++b) {
+                std::uint32_t c = result[(s - 1) * 256 + b];
+                result[s * 256 + b] = (c >> 8) ^ result[c & 0xFFu];
+            }
+        return result;
+    }();
+    const std::uint32_t* t = table.data();
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        std::uint32_t lo = crc ^ (static_cast<std::uint32_t>(p[0]) |
+                                  static_cast<std::uint32_t>(p[1]) << 8 |
+                                  static_cast<std::uint32_t>(p[2]) << 16 |
+                                  static_cast<std::uint32_t>(p[3]) << 24);
+        crc = t[7 * 256 + (lo & 0xFFu)] ^ t[6 * 256 + ((lo >> 8) & 0xFFu)] ^
+              t[5 * 256 + ((lo >> 16) & 0xFFu)] ^ t[4 * 256 + (lo >> 24)] ^
+              t[3 * 256 + p[4]] ^ t[2 * 256 + p[5]] ^ t[256 + p[6]] ^ t[p[7]];
+    }
+    for (; len > 0; --len, ++p)
+        crc = (crc >> 8) ^ t[(crc ^ *p) & 0xFFu];
+
+    return ~crc;
+}
+
+// header of the chunked binary format of qpp::save(), 64 bytes, followed by
+// the CRC-32 of each chunk of elements, by the CRC-32 of the header and of
+// the chunk CRCs, then by the elements in column-major order
+struct ChunkedHeader {
+    char magic[16];            // "QPP::Chunked\0\0\0\0"
+    std::uint32_t version;     // format version
+    std::uint32_t byte_order;  // 0x01020304 written in the machine order
+    std::uint32_t scalar_kind; // see scalar_kind()
+    std::uint32_t scalar_size; // size in bytes of an element
+    std::uint64_t rows;        // number of rows
+    std::uint64_t cols;        // number of columns
+    std::uint64_t chunk;       // elements per chunk, the last may be shorter
+    std::uint64_t nchunks;     // number of chunks
+};
+
+// signature of the chunked binary format
+inline const char* chunked_magic() noexcept { return "QPP::Chunked"; }
+
+// kind of the scalar field: 1 signed integer, 2 unsigned integer, 3 real
+// floating point, 4 complex floating point, 0 other
+template <typename Scalar>
+std::uint32_t scalar_kind() noexcept {
+    return is_complex<Scalar>::value
+               ? 4
+               : std::is_floating_point<Scalar>::value
+                     ? 3
+                     : std::is_integral<Scalar>::value
+                           ? (std::is_signed<Scalar>::value ? 1 : 2)
+                           : 0;
+}
+
+// reads the header of the chunked binary format and the chunk CRCs from the
+// start of fin, throws if they are not valid for elements of type Scalar
+template <typename Scalar>
+void read_chunked_header(std::istream& fin, const std::string& fname,
+                         const std::string& context, ChunkedHeader& header,
+                         std::vector<std::uint32_t>& crcs) {
+    fin.seekg(0);
+    fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!fin || std::strncmp(header.magic, chunked_magic(), 16) != 0)
+        throw std::runtime_error(context + ": Input file \"" + fname +
+                                 "\" is corrupted!");
+    if (header.byte_order != 0x01020304u)
+        throw std::runtime_error(context + ": Input file \"" + fname +
+                                 "\" has a different byte order!");
+    if (header.version != 1)
+        throw std::runtime_error(context + ": Input file \"" + fname +
+                                 "\" has an unsupported format version!");
+    if (header.scalar_kind != scalar_kind<Scalar>() ||
+        header.scalar_size != sizeof(Scalar))
+        throw exception::TypeMismatch(context);
+
+    std::uint64_t N = header.rows * header.cols;
+    bool valid = header.chunk > 0 &&
+                 header.nchunks == (N + header.chunk - 1) / header.chunk;
+    std::uint32_t crc = 0;
+    if (valid) {
+        crcs.resize(static_cast<idx>(header.nchunks));
+        fin.read(reinterpret_cast<char*>(crcs.data()),
+                 static_cast<std::streamsize>(crcs.size() * sizeof(crc)));
+        fin.read(reinterpret_cast<char*>(&crc), sizeof(crc));
+        valid = fin && crc == crc32(crcs.data(), crcs.size() * sizeof(crc),
+                                    crc32(&header, sizeof(header)));
+    }
+    if (!valid)
+        throw std::runtime_error(context + ": Input file \"" + fname +
+                                 "\" is corrupted!");
+}
+
 // implementation details for pretty formatting
 struct Display_Impl_ {
     template <typename T>
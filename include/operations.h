@@ -43,6 +43,10 @@ namespace qpp {
  * the dimension of \a target.
  * Also, all control subsystems in \a ctrl must have the same dimension.
  *
+ * \note A complex gate of another precision than \a state, e.g. a qpp::cmat
+ * gate acting on a qpp::ket_f state, is converted to the precision of
+ * \a state
+ *
  * \param state Eigen expression
  * \param A Eigen expression
  * \param ctrl Control subsystem indexes
@@ -61,9 +65,9 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
 
     // EXCEPTION CHECKS
 
-    // check types
-    if (!std::is_same<typename Derived1::Scalar,
-                      typename Derived2::Scalar>::value)
+    // check types, complex gates of any precision are accepted
+    if (!internal::check_gate_scalar<typename Derived1::Scalar,
+                                     typename Derived2::Scalar>())
         throw exception::TypeMismatch("qpp::applyCTRL()");
 
     // check zero sizes
@@ -113,204 +117,12 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
         throw exception::SubsysMismatchDims("qpp::applyCTRL()");
     // END EXCEPTION CHECKS
 
-    // construct the table of A^i and (A^dagger)^i
-    std::vector<dyn_mat<typename Derived1::Scalar>> Ai;
-    std::vector<dyn_mat<typename Derived1::Scalar>> Aidagger;
-    for (idx i = 0; i < std::max(d, static_cast<idx>(2)); ++i) {
-        Ai.push_back(powm(rA, i));
-        Aidagger.push_back(powm(adjoint(rA), i));
-    }
-
     idx D = static_cast<idx>(rstate.rows()); // total dimension
     idx n = dims.size();                     // total number of subsystems
-    idx ctrlsize = ctrl.size();              // number of ctrl subsystem
-    idx ctrlgatesize = ctrlgate.size();      // number of ctrl+gate subsystems
-    idx targetsize = target.size(); // number of subsystems of the target
-    // dimension of ctrl subsystem
-    idx Dctrl = static_cast<idx>(std::llround(std::pow(d, ctrlsize)));
-    idx DA = static_cast<idx>(rA.rows()); // dimension of gate subsystem
-
-    idx Cdims[maxn];          // local dimensions
-    idx CdimsA[maxn];         // local dimensions
-    idx CdimsCTRL[maxn];      // local dimensions
-    idx CdimsCTRLA_bar[maxn]; // local dimensions
-
-    // compute the complementary subsystem of ctrlgate w.r.t. dims
-    std::vector<idx> ctrlgate_bar = complement(ctrlgate, n);
-    // number of subsystems that are complementary to the ctrl+gate
-    idx ctrlgate_barsize = ctrlgate_bar.size();
-
-    idx DCTRLA_bar = 1; // dimension of the rest
-    for (idx i = 0; i < ctrlgate_barsize; ++i)
-        DCTRLA_bar *= dims[ctrlgate_bar[i]];
-
-    for (idx k = 0; k < n; ++k)
-        Cdims[k] = dims[k];
-    for (idx k = 0; k < targetsize; ++k)
-        CdimsA[k] = dims[target[k]];
-    for (idx k = 0; k < ctrlsize; ++k)
-        CdimsCTRL[k] = d;
-    for (idx k = 0; k < ctrlgate_barsize; ++k)
-        CdimsCTRLA_bar[k] = dims[ctrlgate_bar[k]];
-
-    // worker, computes the coefficient and the index for the ket case
-    // used in #pragma omp parallel for collapse
-    auto coeff_idx_ket = [&](idx i_, idx m_, idx r_) noexcept
-                             ->std::pair<typename Derived1::Scalar, idx> {
-        idx indx = 0;
-        typename Derived1::Scalar coeff = 0;
-
-        idx Cmidx[maxn];          // the total multi-index
-        idx CmidxA[maxn];         // the gate part multi-index
-        idx CmidxCTRLA_bar[maxn]; // the rest multi-index
-
-        // compute the index
-
-        // set the CTRL part
-        for (idx k = 0; k < ctrlsize; ++k) {
-            Cmidx[ctrl[k]] = i_;
-        }
-
-        // set the rest
-        internal::n2multiidx(r_, n - ctrlgatesize, CdimsCTRLA_bar,
-                             CmidxCTRLA_bar);
-        for (idx k = 0; k < n - ctrlgatesize; ++k) {
-            Cmidx[ctrlgate_bar[k]] = CmidxCTRLA_bar[k];
-        }
-
-        // set the A part
-        internal::n2multiidx(m_, targetsize, CdimsA, CmidxA);
-        for (idx k = 0; k < targetsize; ++k) {
-            Cmidx[target[k]] = CmidxA[k];
-        }
 
-        // we now got the total index
-        indx = internal::multiidx2n(Cmidx, n, Cdims);
-
-        // compute the coefficient
-        for (idx n_ = 0; n_ < DA; ++n_) {
-            internal::n2multiidx(n_, targetsize, CdimsA, CmidxA);
-            for (idx k = 0; k < targetsize; ++k) {
-                Cmidx[target[k]] = CmidxA[k];
-            }
-            coeff +=
-                Ai[i_](m_, n_) * rstate(internal::multiidx2n(Cmidx, n, Cdims));
-        }
-
-        return std::make_pair(coeff, indx);
-    }; /* end coeff_idx_ket */
-
-    // worker, computes the coefficient and the index
-    // for the density matrix case
-    // used in #pragma omp parallel for collapse
-    auto coeff_idx_rho = [&](idx i1_, idx m1_, idx r1_, idx i2_, idx m2_,
-                             idx r2_) noexcept
-                             ->std::tuple<typename Derived1::Scalar, idx, idx> {
-        idx idxrow = 0;
-        idx idxcol = 0;
-        typename Derived1::Scalar coeff = 0, lhs = 1, rhs = 1;
-
-        idx Cmidxrow[maxn];          // the total row multi-index
-        idx Cmidxcol[maxn];          // the total col multi-index
-        idx CmidxArow[maxn];         // the gate part row multi-index
-        idx CmidxAcol[maxn];         // the gate part col multi-index
-        idx CmidxCTRLrow[maxn];      // the control row multi-index
-        idx CmidxCTRLcol[maxn];      // the control col multi-index
-        idx CmidxCTRLA_barrow[maxn]; // the rest row multi-index
-        idx CmidxCTRLA_barcol[maxn]; // the rest col multi-index
-
-        // compute the ket/bra indexes
-
-        // set the CTRL part
-        internal::n2multiidx(i1_, ctrlsize, CdimsCTRL, CmidxCTRLrow);
-        internal::n2multiidx(i2_, ctrlsize, CdimsCTRL, CmidxCTRLcol);
-
-        for (idx k = 0; k < ctrlsize; ++k) {
-            Cmidxrow[ctrl[k]] = CmidxCTRLrow[k];
-            Cmidxcol[ctrl[k]] = CmidxCTRLcol[k];
-        }
-
-        // set the rest
-        internal::n2multiidx(r1_, n - ctrlgatesize, CdimsCTRLA_bar,
-                             CmidxCTRLA_barrow);
-        internal::n2multiidx(r2_, n - ctrlgatesize, CdimsCTRLA_bar,
-                             CmidxCTRLA_barcol);
-        for (idx k = 0; k < n - ctrlgatesize; ++k) {
-            Cmidxrow[ctrlgate_bar[k]] = CmidxCTRLA_barrow[k];
-            Cmidxcol[ctrlgate_bar[k]] = CmidxCTRLA_barcol[k];
-        }
-
-        // set the A part
-        internal::n2multiidx(m1_, targetsize, CdimsA, CmidxArow);
-        internal::n2multiidx(m2_, targetsize, CdimsA, CmidxAcol);
-        for (idx k = 0; k < target.size(); ++k) {
-            Cmidxrow[target[k]] = CmidxArow[k];
-            Cmidxcol[target[k]] = CmidxAcol[k];
-        }
-
-        // we now got the total row/col indexes
-        idxrow = internal::multiidx2n(Cmidxrow, n, Cdims);
-        idxcol = internal::multiidx2n(Cmidxcol, n, Cdims);
-
-        // check whether all CTRL row and col multi indexes are equal
-        bool all_ctrl_rows_equal = true;
-        bool all_ctrl_cols_equal = true;
-
-        idx first_ctrl_row, first_ctrl_col;
-        if (ctrlsize > 0) {
-            first_ctrl_row = CmidxCTRLrow[0];
-            first_ctrl_col = CmidxCTRLcol[0];
-        } else {
-            first_ctrl_row = first_ctrl_col = 1;
-        }
-
-        for (idx k = 1; k < ctrlsize; ++k) {
-            if (CmidxCTRLrow[k] != first_ctrl_row) {
-                all_ctrl_rows_equal = false;
-                break;
-            }
-        }
-        for (idx k = 1; k < ctrlsize; ++k) {
-            if (CmidxCTRLcol[k] != first_ctrl_col) {
-                all_ctrl_cols_equal = false;
-                break;
-            }
-        }
-
-        // at least one control activated, compute the coefficient
-        for (idx n1_ = 0; n1_ < DA; ++n1_) {
-            internal::n2multiidx(n1_, targetsize, CdimsA, CmidxArow);
-            for (idx k = 0; k < targetsize; ++k) {
-                Cmidxrow[target[k]] = CmidxArow[k];
-            }
-            idx idxrowtmp = internal::multiidx2n(Cmidxrow, n, Cdims);
-
-            if (all_ctrl_rows_equal) {
-                lhs = Ai[first_ctrl_row](m1_, n1_);
-            } else {
-                lhs = (m1_ == n1_) ? 1 : 0; // identity matrix
-            }
-
-            for (idx n2_ = 0; n2_ < DA; ++n2_) {
-                internal::n2multiidx(n2_, targetsize, CdimsA, CmidxAcol);
-                for (idx k = 0; k < targetsize; ++k) {
-                    Cmidxcol[target[k]] = CmidxAcol[k];
-                }
-
-                if (all_ctrl_cols_equal) {
-                    rhs = Aidagger[first_ctrl_col](n2_, m2_);
-                } else {
-                    rhs = (n2_ == m2_) ? 1 : 0; // identity matrix
-                }
-
-                idx idxcoltmp = internal::multiidx2n(Cmidxcol, n, Cdims);
-
-                coeff += lhs * rstate(idxrowtmp, idxcoltmp) * rhs;
-            }
-        }
-
-        return std::make_tuple(coeff, idxrow, idxcol);
-    }; /* end coeff_idx_rho */
+    // the gate in the precision of the state
+    const dyn_mat<typename Derived1::Scalar> gate =
+        rA.template cast<typename Derived1::Scalar>();
 
     //************ ket ************//
     if (internal::check_cvector(rstate)) // we have a ket
@@ -322,22 +134,8 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
             return rstate;
 
         dyn_mat<typename Derived1::Scalar> result = rstate;
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for collapse(2)
-#endif // WITH_OPENMP_
-        for (idx m = 0; m < DA; ++m)
-            for (idx r = 0; r < DCTRLA_bar; ++r) {
-                if (ctrlsize == 0) // no control
-                {
-                    result(coeff_idx_ket(1, m, r).second) =
-                        coeff_idx_ket(1, m, r).first;
-                } else
-                    for (idx i = 0; i < d; ++i) {
-                        result(coeff_idx_ket(i, m, r).second) =
-                            coeff_idx_ket(i, m, r).first;
-                    }
-            }
+        // dedicated kernels for qubit gates acting on 1 or 2 targets
+        internal::apply_ctrl_ket_inplace(result, gate, ctrl, target, dims);
 
         return result;
     }
@@ -351,32 +149,25 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
         if (D == 1)
             return rstate;
 
-        dyn_mat<typename Derived1::Scalar> result = rstate;
+        // the column-major storage of the D x D matrix is a ket over the
+        // 2n subsystems (columns, rows), apply CTRL-A on the row subsystems,
+        // i.e. CTRL-A * rho, then CTRL-conj(A) on the column subsystems,
+        // i.e. (CTRL-A * rho) * CTRL-A^dagger, both passes are in place
+        std::vector<idx> dims2 = dims;
+        dims2.insert(std::end(dims2), std::begin(dims), std::end(dims));
+        std::vector<idx> ctrl_rows = ctrl;
+        for (auto&& elem : ctrl_rows)
+            elem += n;
+        std::vector<idx> target_rows = target;
+        for (auto&& elem : target_rows)
+            elem += n;
 
-#ifdef WITH_OPENMP_
-#pragma omp parallel for collapse(4)
-#endif // WITH_OPENMP_
-        for (idx m1 = 0; m1 < DA; ++m1)
-            for (idx r1 = 0; r1 < DCTRLA_bar; ++r1)
-                for (idx m2 = 0; m2 < DA; ++m2)
-                    for (idx r2 = 0; r2 < DCTRLA_bar; ++r2)
-                        if (ctrlsize == 0) // no control
-                        {
-                            auto coeff_idxes =
-                                coeff_idx_rho(1, m1, r1, 1, m2, r2);
-                            result(std::get<1>(coeff_idxes),
-                                   std::get<2>(coeff_idxes)) =
-                                std::get<0>(coeff_idxes);
-                        } else {
-                            for (idx i1 = 0; i1 < Dctrl; ++i1)
-                                for (idx i2 = 0; i2 < Dctrl; ++i2) {
-                                    auto coeff_idxes =
-                                        coeff_idx_rho(i1, m1, r1, i2, m2, r2);
-                                    result(std::get<1>(coeff_idxes),
-                                           std::get<2>(coeff_idxes)) =
-                                        std::get<0>(coeff_idxes);
-                                }
-                        }
+        dyn_mat<typename Derived1::Scalar> result = rstate;
+        internal::apply_ctrl_ket_inplace(result, gate, ctrl_rows,
+                                         target_rows, dims2);
+        internal::apply_ctrl_ket_inplace(
+            result, dyn_mat<typename Derived1::Scalar>(gate.conjugate()), ctrl,
+            target, dims2);
 
         return result;
     }
@@ -407,7 +198,7 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
           const std::vector<idx>& target, idx d = 2) {
     const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate =
         state.derived();
-    const dyn_mat<typename Derived1::Scalar>& rA = A.derived();
+    const dyn_mat<typename Derived2::Scalar>& rA = A.derived();
 
     // EXCEPTION CHECKS
 
@@ -426,6 +217,162 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
     return applyCTRL(rstate, rA, ctrl, target, dims);
 }
 
+/**
+ * \brief Applies the controlled permutation gate \a perm to the part
+ * \a target of the multi-partite state vector or density matrix \a state
+ * \see qpp::Gates::MODMUL_perm()
+ *
+ * The permutation gate maps the basis state \f$|m\rangle\f$ of \a target to
+ * \f$|perm[m]\rangle\f$, the basis states being indexed in the standard
+ * lexicographical order. It is applied by moving the amplitudes in place,
+ * without constructing its matrix, i.e. in \f$O(D)\f$ time for a state
+ * vector of dimension \f$D\f$.
+ *
+ * \note The size of \a perm must match the dimension of \a target.
+ * Also, all control subsystems in \a ctrl must have the same dimension.
+ *
+ * \param state Eigen expression
+ * \param perm Permutation of the basis states of \a target
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the permutation gate is applied
+ * \param dims Dimensions of the multi-partite system
+ * \return CTRL-perm gate applied to the part \a target of \a state
+ */
+template <typename Derived>
+dyn_mat<typename Derived::Scalar>
+applyCTRL(const Eigen::MatrixBase<Derived>& state, const std::vector<idx>& perm,
+          const std::vector<idx>& ctrl, const std::vector<idx>& target,
+          const std::vector<idx>& dims) {
+    const typename Eigen::MatrixBase<Derived>::EvalReturnType& rstate =
+        state.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::applyCTRL()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(target))
+        throw exception::ZeroSize("qpp::applyCTRL()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::applyCTRL()");
+
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
+
+    std::vector<idx> ctrlgate = ctrl; // ctrl + gate subsystem vector
+    ctrlgate.insert(std::end(ctrlgate), std::begin(target), std::end(target));
+    std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+
+    // check that ctrl + gate subsystem is valid
+    // with respect to local dimensions
+    if (!internal::check_subsys_match_dims(ctrlgate, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL()");
+
+    // check that all control subsystems have the same dimension
+    for (idx i = 1; i < ctrl.size(); ++i)
+        if (dims[ctrl[i]] != dims[ctrl[0]])
+            throw exception::DimsNotEqual("qpp::applyCTRL()");
+
+    // check valid permutation
+    if (!internal::check_perm(perm))
+        throw exception::PermInvalid("qpp::applyCTRL()");
+
+    // check that the permutation matches the dimension of the target
+    idx DA = 1;
+    for (auto&& elem : target)
+        DA *= dims[elem];
+    if (perm.size() != DA)
+        throw exception::PermMismatchDims("qpp::applyCTRL()");
+    // END EXCEPTION CHECKS
+
+    idx n = dims.size(); // total number of subsystems
+
+    //************ ket ************//
+    if (internal::check_cvector(rstate)) // we have a ket
+    {
+        // check that dims match state vector
+        if (!internal::check_dims_match_cvect(dims, rstate))
+            throw exception::DimsMismatchCvector("qpp::applyCTRL()");
+
+        dyn_mat<typename Derived::Scalar> result = rstate;
+        internal::apply_perm_ket_inplace(result, perm, ctrl, target, dims);
+
+        return result;
+    }
+    //************ density matrix ************//
+    else if (internal::check_square_mat(rstate)) // we have a density operator
+    {
+        // check that dims match state matrix
+        if (!internal::check_dims_match_mat(dims, rstate))
+            throw exception::DimsMismatchMatrix("qpp::applyCTRL()");
+
+        // same two passes as for qpp::applyCTRL(), the permutation matrix
+        // is real
+        std::vector<idx> dims2 = dims;
+        dims2.insert(std::end(dims2), std::begin(dims), std::end(dims));
+        std::vector<idx> ctrl_rows = ctrl;
+        for (auto&& elem : ctrl_rows)
+            elem += n;
+        std::vector<idx> target_rows = target;
+        for (auto&& elem : target_rows)
+            elem += n;
+
+        dyn_mat<typename Derived::Scalar> result = rstate;
+        internal::apply_perm_ket_inplace(result, perm, ctrl_rows, target_rows,
+                                         dims2);
+        internal::apply_perm_ket_inplace(result, perm, ctrl, target, dims2);
+
+        return result;
+    }
+    //************ Exception: not ket nor density matrix ************//
+    else
+        throw exception::MatrixNotSquareNorCvector("qpp::applyCTRL()");
+}
+
+/**
+ * \brief Applies the controlled permutation gate \a perm to the part
+ * \a target of the multi-partite state vector or density matrix \a state
+ * \see qpp::Gates::MODMUL_perm()
+ *
+ * \note The size of \a perm must match the dimension of \a target
+ *
+ * \param state Eigen expression
+ * \param perm Permutation of the basis states of \a target
+ * \param ctrl Control subsystem indexes
+ * \param target Subsystem indexes where the permutation gate is applied
+ * \param d Subsystem dimensions
+ * \return CTRL-perm gate applied to the part \a target of \a state
+ */
+template <typename Derived>
+dyn_mat<typename Derived::Scalar>
+applyCTRL(const Eigen::MatrixBase<Derived>& state, const std::vector<idx>& perm,
+          const std::vector<idx>& ctrl, const std::vector<idx>& target,
+          idx d = 2) {
+    const typename Eigen::MatrixBase<Derived>::EvalReturnType& rstate =
+        state.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::applyCTRL()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::applyCTRL()");
+    // END EXCEPTION CHECKS
+
+    idx n = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    return applyCTRL(rstate, perm, ctrl, target, dims);
+}
+
 /**
  * \brief Applies the gate \a A to the part \a target of the multi-partite state
  * vector or density matrix \a state
@@ -433,6 +380,9 @@ applyCTRL(const Eigen::MatrixBase<Derived1>& state,
  * \note The dimension of the gate \a A must match
  * the dimension of \a target
  *
+ * \note A complex gate of another precision than \a state is converted to
+ * the precision of \a state, see qpp::applyCTRL()
+ *
  * \param state Eigen expression
  * \param A Eigen expression
  * \param target Subsystem indexes where the gate \a A is applied
@@ -450,9 +400,9 @@ apply(const Eigen::MatrixBase<Derived1>& state,
 
     // EXCEPTION CHECKS
 
-    // check types
-    if (!std::is_same<typename Derived1::Scalar,
-                      typename Derived2::Scalar>::value)
+    // check types, complex gates of any precision are accepted
+    if (!internal::check_gate_scalar<typename Derived1::Scalar,
+                                     typename Derived2::Scalar>())
         throw exception::TypeMismatch("qpp::apply()");
 
     // check zero sizes
@@ -530,7 +480,7 @@ apply(const Eigen::MatrixBase<Derived1>& state,
       idx d = 2) {
     const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate =
         state.derived();
-    const dyn_mat<typename Derived1::Scalar>& rA = A.derived();
+    const dyn_mat<typename Derived2::Scalar>& rA = A.derived();
 
     // EXCEPTION CHECKS
 
@@ -549,6 +499,196 @@ apply(const Eigen::MatrixBase<Derived1>& state,
     return apply(rstate, rA, target, dims);
 }
 
+/**
+ * \brief Applies the sparse gate \a A to the part \a target of the
+ * multi-partite state vector or density matrix \a state
+ * \see qpp::Gates::CTRL_sparse(), qpp::Gates::expandout_sparse()
+ *
+ * \note The dimension of the gate \a A must match
+ * the dimension of \a target
+ *
+ * \note The cost is proportional to the number of non-zero entries of \a A,
+ * so that gates acting on all subsystems, such as the output of
+ * qpp::Gates::CTRL_sparse(), can be applied without ever being stored as
+ * dense matrices
+ *
+ * \param state Eigen expression
+ * \param A Sparse Eigen expression
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param dims Dimensions of the multi-partite system
+ * \return Gate \a A applied to the part \a target of \a state
+ */
+template <typename Derived1, typename Derived2>
+dyn_mat<typename Derived1::Scalar>
+apply(const Eigen::MatrixBase<Derived1>& state,
+      const Eigen::SparseMatrixBase<Derived2>& A,
+      const std::vector<idx>& target, const std::vector<idx>& dims) {
+    const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate =
+        state.derived();
+    const dyn_sparse_mat<typename Derived2::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check types, complex gates of any precision are accepted
+    if (!internal::check_gate_scalar<typename Derived1::Scalar,
+                                     typename Derived2::Scalar>())
+        throw exception::TypeMismatch("qpp::apply()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::apply()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::apply()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(target))
+        throw exception::ZeroSize("qpp::apply()");
+
+    // check square matrix for the gate
+    if (rA.rows() != rA.cols())
+        throw exception::MatrixNotSquare("qpp::apply()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::apply()");
+
+    // check that target is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(target, dims))
+        throw exception::SubsysMismatchDims("qpp::apply()");
+
+    // check that gate matches the dimensions of the target
+    idx DA = 1;
+    for (idx i = 0; i < target.size(); ++i)
+        DA *= dims[target[i]];
+    if (static_cast<idx>(rA.rows()) != DA)
+        throw exception::MatrixMismatchSubsys("qpp::apply()");
+    // END EXCEPTION CHECKS
+
+    // the gate in the precision of the state
+    const dyn_sparse_mat<typename Derived1::Scalar> gate =
+        rA.template cast<typename Derived1::Scalar>();
+
+    //************ ket ************//
+    if (internal::check_cvector(rstate)) // we have a ket
+    {
+        // check that dims match state vector
+        if (!internal::check_dims_match_cvect(dims, rstate))
+            throw exception::DimsMismatchCvector("qpp::apply()");
+
+        dyn_mat<typename Derived1::Scalar> result = rstate;
+        internal::apply_sparse_ket_inplace(result, gate, target, dims);
+
+        return result;
+    }
+    //************ density matrix ************//
+    else if (internal::check_square_mat(rstate)) // we have a density operator
+    {
+        // check that dims match state matrix
+        if (!internal::check_dims_match_mat(dims, rstate))
+            throw exception::DimsMismatchMatrix("qpp::apply()");
+
+        // same two passes as for qpp::applyCTRL()
+        idx n = dims.size();
+        std::vector<idx> dims2 = dims;
+        dims2.insert(std::end(dims2), std::begin(dims), std::end(dims));
+        std::vector<idx> target_rows = target;
+        for (auto&& elem : target_rows)
+            elem += n;
+
+        dyn_mat<typename Derived1::Scalar> result = rstate;
+        internal::apply_sparse_ket_inplace(result, gate, target_rows, dims2);
+        internal::apply_sparse_ket_inplace(
+            result, dyn_sparse_mat<typename Derived1::Scalar>(gate.conjugate()),
+            target, dims2);
+
+        return result;
+    }
+    //************ Exception: not ket nor density matrix ************//
+    else
+        throw exception::MatrixNotSquareNorCvector("qpp::apply()");
+}
+
+/**
+ * \brief Applies the sparse gate \a A to the part \a target of the
+ * multi-partite state vector or density matrix \a state
+ * \see qpp::Gates::CTRL_sparse(), qpp::Gates::expandout_sparse()
+ *
+ * \note The dimension of the gate \a A must match
+ * the dimension of \a target
+ *
+ * \param state Eigen expression
+ * \param A Sparse Eigen expression
+ * \param target Subsystem indexes where the gate \a A is applied
+ * \param d Subsystem dimensions
+ * \return Gate \a A applied to the part \a target of \a state
+ */
+template <typename Derived1, typename Derived2>
+dyn_mat<typename Derived1::Scalar>
+apply(const Eigen::MatrixBase<Derived1>& state,
+      const Eigen::SparseMatrixBase<Derived2>& A,
+      const std::vector<idx>& target, idx d = 2) {
+    const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate =
+        state.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::apply()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::apply()");
+    // END EXCEPTION CHECKS
+
+    idx n = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    return apply(rstate, A, target, dims);
+}
+
+/**
+ * \brief Applies the permutation gate \a perm to the part \a target of the
+ * multi-partite state vector or density matrix \a state
+ * \see qpp::applyCTRL() for permutation gates
+ *
+ * \note The size of \a perm must match the dimension of \a target
+ *
+ * \param state Eigen expression
+ * \param perm Permutation of the basis states of \a target
+ * \param target Subsystem indexes where the permutation gate is applied
+ * \param dims Dimensions of the multi-partite system
+ * \return Permutation gate applied to the part \a target of \a state
+ */
+template <typename Derived>
+dyn_mat<typename Derived::Scalar>
+apply(const Eigen::MatrixBase<Derived>& state, const std::vector<idx>& perm,
+      const std::vector<idx>& target, const std::vector<idx>& dims) {
+    return applyCTRL(state, perm, {}, target, dims);
+}
+
+/**
+ * \brief Applies the permutation gate \a perm to the part \a target of the
+ * multi-partite state vector or density matrix \a state
+ * \see qpp::applyCTRL() for permutation gates
+ *
+ * \note The size of \a perm must match the dimension of \a target
+ *
+ * \param state Eigen expression
+ * \param perm Permutation of the basis states of \a target
+ * \param target Subsystem indexes where the permutation gate is applied
+ * \param d Subsystem dimensions
+ * \return Permutation gate applied to the part \a target of \a state
+ */
+template <typename Derived>
+dyn_mat<typename Derived::Scalar>
+apply(const Eigen::MatrixBase<Derived>& state, const std::vector<idx>& perm,
+      const std::vector<idx>& target, idx d = 2) {
+    return applyCTRL(state, perm, {}, target, d);
+}
+
 /**
  * \brief Applies the channel specified by the set of Kraus operators \a Ks to
  * the density matrix \a A
@@ -578,16 +718,28 @@ cmat apply(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks) {
             throw exception::DimsNotEqual("qpp::apply()");
     // END EXCEPTION CHECKS
 
-    cmat result = cmat::Zero(rA.rows(), rA.rows());
+    idx D = static_cast<idx>(rA.rows());
+    cmat result = cmat::Zero(D, D);
 
+    // each thread accumulates its own partial sum, the partial sums are added
+    // together only once per thread
 #ifdef WITH_OPENMP_
-#pragma omp parallel for
+#pragma omp parallel
 #endif // WITH_OPENMP_
-    for (idx i = 0; i < Ks.size(); ++i) {
+    {
+        cmat partial = cmat::Zero(D, D);
+        cmat tmp(D, D);
+#ifdef WITH_OPENMP_
+#pragma omp for nowait
+#endif // WITH_OPENMP_
+        for (idx i = 0; i < Ks.size(); ++i) {
+            tmp.noalias() = Ks[i] * rA;
+            partial.noalias() += tmp * adjoint(Ks[i]);
+        }
 #ifdef WITH_OPENMP_
 #pragma omp critical
 #endif // WITH_OPENMP_
-        { result += Ks[i] * rA * adjoint(Ks[i]); }
+        { result += partial; }
     }
 
     return result;
@@ -650,10 +802,45 @@ cmat apply(const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks,
             throw exception::DimsNotEqual("qpp::apply()");
     // END EXCEPTION CHECKS
 
-    cmat result = cmat::Zero(rA.rows(), rA.rows());
+    idx n = dims.size();
+    idx DA = static_cast<idx>(Ks[0].rows());
+
+    // the column-major storage of rA is a ket over the 2n subsystems
+    // (columns, rows), see qpp::applyCTRL()
+    std::vector<idx> dims2 = dims;
+    dims2.insert(std::end(dims2), std::begin(dims), std::end(dims));
+    std::vector<idx> target_rows = target;
+    for (auto&& elem : target_rows)
+        elem += n;
+
+    // small targets, one in-place pass of the local superoperator
+    // sum_i conj(K_i) \otimes K_i acting jointly on the column and row
+    // target subsystems; costs D^2 * DA^2, versus 2 * D^2 * DA per Kraus
+    // operator for the passes below
+    if (DA <= 2 * Ks.size()) {
+        std::vector<idx> target2 = target;
+        target2.insert(std::end(target2), std::begin(target_rows),
+                       std::end(target_rows));
+        cmat S = cmat::Zero(DA * DA, DA * DA);
+        for (auto&& elem : Ks)
+            S += kron(cmat(elem.conjugate()), elem);
+
+        cmat result = rA;
+        internal::apply_ctrl_ket_inplace(result, S, {}, target2, dims2);
 
-    for (idx i = 0; i < Ks.size(); ++i)
-        result += apply(rA, Ks[i], target, dims);
+        return result;
+    }
+
+    // large targets, each Kraus operator through two strided passes
+    cmat result = cmat::Zero(rA.rows(), rA.rows());
+    cmat tmp;
+    for (auto&& elem : Ks) {
+        tmp = rA;
+        internal::apply_ctrl_ket_inplace(tmp, elem, {}, target_rows, dims2);
+        internal::apply_ctrl_ket_inplace(tmp, cmat(elem.conjugate()), {},
+                                         target, dims2);
+        result += tmp;
+    }
 
     return result;
 }
@@ -1207,34 +1394,12 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
     idx D = static_cast<idx>(rA.rows());
     idx n = dims.size();
     idx n_subsys = target.size();
-    idx n_subsys_bar = n - n_subsys;
     idx Dsubsys = 1;
     for (idx i = 0; i < n_subsys; ++i)
         Dsubsys *= dims[target[i]];
     idx Dsubsys_bar = D / Dsubsys;
 
-    idx Cdims[maxn];
-    idx Csubsys[maxn];
-    idx Cdimssubsys[maxn];
-    idx Csubsys_bar[maxn];
-    idx Cdimssubsys_bar[maxn];
-
-    idx Cmidxcolsubsys_bar[maxn];
-
     std::vector<idx> subsys_bar = complement(target, n);
-    std::copy(std::begin(subsys_bar), std::end(subsys_bar),
-              std::begin(Csubsys_bar));
-
-    for (idx i = 0; i < n; ++i) {
-        Cdims[i] = dims[i];
-    }
-    for (idx i = 0; i < n_subsys; ++i) {
-        Csubsys[i] = target[i];
-        Cdimssubsys[i] = dims[target[i]];
-    }
-    for (idx i = 0; i < n_subsys_bar; ++i) {
-        Cdimssubsys_bar[i] = dims[subsys_bar[i]];
-    }
 
     dyn_mat<typename Derived::Scalar> result =
         dyn_mat<typename Derived::Scalar>(Dsubsys_bar, Dsubsys_bar);
@@ -1254,53 +1419,9 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
         if (target.size() == 0)
             return rA * adjoint(rA);
 
-        auto worker = [&](idx i) noexcept->typename Derived::Scalar {
-            // use static allocation for speed!
-
-            idx Cmidxrow[maxn];
-            idx Cmidxcol[maxn];
-            idx Cmidxrowsubsys_bar[maxn];
-            idx Cmidxsubsys[maxn];
-
-            /* get the row multi-indexes of the complement */
-            internal::n2multiidx(i, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxrowsubsys_bar);
-            /* write them in the global row/col multi-indexes */
-            for (idx k = 0; k < n_subsys_bar; ++k) {
-                Cmidxrow[Csubsys_bar[k]] = Cmidxrowsubsys_bar[k];
-                Cmidxcol[Csubsys_bar[k]] = Cmidxcolsubsys_bar[k];
-            }
-            typename Derived::Scalar sm = 0;
-            for (idx a = 0; a < Dsubsys; ++a) {
-                // get the multi-index over which we do the summation
-                internal::n2multiidx(a, n_subsys, Cdimssubsys, Cmidxsubsys);
-                // write it into the global row/col multi-indexes
-                for (idx k = 0; k < n_subsys; ++k)
-                    Cmidxrow[Csubsys[k]] = Cmidxcol[Csubsys[k]] =
-                        Cmidxsubsys[k];
-
-                // now do the sum
-                sm += rA(internal::multiidx2n(Cmidxrow, n, Cdims)) *
-                      std::conj(rA(internal::multiidx2n(Cmidxcol, n, Cdims)));
-            }
-
-            return sm;
-        }; /* end worker */
-
-        for (idx j = 0; j < Dsubsys_bar; ++j) // column major order for speed
-        {
-            // compute the column multi-indexes of the complement
-            internal::n2multiidx(j, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxcolsubsys_bar);
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-            for (idx i = 0; i < Dsubsys_bar; ++i) {
-                result(i, j) = worker(i);
-            }
-        }
-
-        return result;
+        // the ket reshaped as a Dsubsys_bar x Dsubsys matrix M, the result
+        // is M * M^dagger, see internal/kernels.h
+        return internal::reduced_rho_ket(rA, subsys_bar, dims);
     }
     //************ density matrix ************//
     else if (internal::check_square_mat(rA)) // we have a density operator
@@ -1317,49 +1438,22 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
         if (target.size() == 0)
             return rA;
 
-        auto worker = [&](idx i) noexcept->typename Derived::Scalar {
-            // use static allocation for speed!
-
-            idx Cmidxrow[maxn];
-            idx Cmidxcol[maxn];
-            idx Cmidxrowsubsys_bar[maxn];
-            idx Cmidxsubsys[maxn];
-
-            /* get the row/col multi-indexes of the complement */
-            internal::n2multiidx(i, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxrowsubsys_bar);
-            /* write them in the global row/col multi-indexes */
-            for (idx k = 0; k < n_subsys_bar; ++k) {
-                Cmidxrow[Csubsys_bar[k]] = Cmidxrowsubsys_bar[k];
-                Cmidxcol[Csubsys_bar[k]] = Cmidxcolsubsys_bar[k];
-            }
-            typename Derived::Scalar sm = 0;
-            for (idx a = 0; a < Dsubsys; ++a) {
-                // get the multi-index over which we do the summation
-                internal::n2multiidx(a, n_subsys, Cdimssubsys, Cmidxsubsys);
-                // write it into the global row/col multi-indexes
-                for (idx k = 0; k < n_subsys; ++k)
-                    Cmidxrow[Csubsys[k]] = Cmidxcol[Csubsys[k]] =
-                        Cmidxsubsys[k];
-
-                // now do the sum
-                sm += rA(internal::multiidx2n(Cmidxrow, n, Cdims),
-                         internal::multiidx2n(Cmidxcol, n, Cdims));
-            }
-
-            return sm;
-        }; /* end worker */
+        // row/column indexes of the result, and offsets over which the sum
+        // is performed
+        internal::IndexPlan plan{dims, target};
+        std::vector<idx> bases = plan.offsets(subsys_bar);
+        std::vector<idx> offsets = plan.offsets(target);
 
         for (idx j = 0; j < Dsubsys_bar; ++j) // column major order for speed
         {
-            // compute the column multi-indexes of the complement
-            internal::n2multiidx(j, n_subsys_bar, Cdimssubsys_bar,
-                                 Cmidxcolsubsys_bar);
 #ifdef WITH_OPENMP_
 #pragma omp parallel for
 #endif // WITH_OPENMP_
             for (idx i = 0; i < Dsubsys_bar; ++i) {
-                result(i, j) = worker(i);
+                typename Derived::Scalar sm = 0;
+                for (idx a = 0; a < Dsubsys; ++a)
+                    sm += rA(bases[i] + offsets[a], bases[j] + offsets[a]);
+                result(i, j) = sm;
             }
         }
 
@@ -1443,16 +1537,15 @@ ptranspose(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
 
     idx D = static_cast<idx>(rA.rows());
     idx n = dims.size();
-    idx n_subsys = target.size();
-    idx Cdims[maxn];
-    idx Cmidxcol[maxn];
-    idx Csubsys[maxn];
 
-    // copy dims in Cdims and target in Csubsys
-    for (idx i = 0; i < n; ++i)
-        Cdims[i] = dims[i];
-    for (idx i = 0; i < n_subsys; ++i)
-        Csubsys[i] = target[i];
+    // the row and column indexes are split into a part over the subsystems
+    // that are not transposed (bases) and a part over target (offsets), the
+    // latter being exchanged between the row and the column
+    internal::IndexPlan plan{dims, target};
+    std::vector<idx> bases = plan.offsets(complement(target, n));
+    std::vector<idx> offsets = plan.offsets(target);
+    idx Dsubsys = offsets.size();
+    idx Dsubsys_bar = bases.size();
 
     dyn_mat<typename Derived::Scalar> result(D, D);
 
@@ -1469,35 +1562,18 @@ ptranspose(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
         if (target.size() == 0)
             return rA * adjoint(rA);
 
-        auto worker = [&](idx i) noexcept->typename Derived::Scalar {
-            // use static allocation for speed!
-            idx midxcoltmp[maxn];
-            idx midxrow[maxn];
-
-            for (idx k = 0; k < n; ++k)
-                midxcoltmp[k] = Cmidxcol[k];
-
-            /* compute the row multi-index */
-            internal::n2multiidx(i, n, Cdims, midxrow);
-
-            for (idx k = 0; k < n_subsys; ++k)
-                std::swap(midxcoltmp[Csubsys[k]], midxrow[Csubsys[k]]);
-
-            /* writes the result */
-            return rA(internal::multiidx2n(midxrow, n, Cdims)) *
-                   std::conj(rA(internal::multiidx2n(midxcoltmp, n, Cdims)));
-        }; /* end worker */
-
-        for (idx j = 0; j < D; ++j) {
-            // compute the column multi-index
-            internal::n2multiidx(j, n, Cdims, Cmidxcol);
-
 #ifdef WITH_OPENMP_
 #pragma omp parallel for
 #endif // WITH_OPENMP_
-            for (idx i = 0; i < D; ++i)
-                result(i, j) = worker(i);
-        }
+        for (idx jb = 0; jb < Dsubsys_bar; ++jb)
+            for (idx jt = 0; jt < Dsubsys; ++jt) {
+                idx j = bases[jb] + offsets[jt];
+                for (idx ib = 0; ib < Dsubsys_bar; ++ib)
+                    for (idx it = 0; it < Dsubsys; ++it)
+                        result(bases[ib] + offsets[it], j) =
+                            rA(bases[ib] + offsets[jt]) *
+                            std::conj(rA(bases[jb] + offsets[it]));
+            }
 
         return result;
     }
@@ -1514,35 +1590,18 @@ ptranspose(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& target,
         if (target.size() == 0)
             return rA;
 
-        auto worker = [&](idx i) noexcept->typename Derived::Scalar {
-            // use static allocation for speed!
-            idx midxcoltmp[maxn];
-            idx midxrow[maxn];
-
-            for (idx k = 0; k < n; ++k)
-                midxcoltmp[k] = Cmidxcol[k];
-
-            /* compute the row multi-index */
-            internal::n2multiidx(i, n, Cdims, midxrow);
-
-            for (idx k = 0; k < n_subsys; ++k)
-                std::swap(midxcoltmp[Csubsys[k]], midxrow[Csubsys[k]]);
-
-            /* writes the result */
-            return rA(internal::multiidx2n(midxrow, n, Cdims),
-                      internal::multiidx2n(midxcoltmp, n, Cdims));
-        }; /* end worker */
-
-        for (idx j = 0; j < D; ++j) {
-            // compute the column multi-index
-            internal::n2multiidx(j, n, Cdims, Cmidxcol);
-
 #ifdef WITH_OPENMP_
 #pragma omp parallel for
 #endif // WITH_OPENMP_
-            for (idx i = 0; i < D; ++i)
-                result(i, j) = worker(i);
-        }
+        for (idx jb = 0; jb < Dsubsys_bar; ++jb)
+            for (idx jt = 0; jt < Dsubsys; ++jt) {
+                idx j = bases[jb] + offsets[jt];
+                for (idx ib = 0; ib < Dsubsys_bar; ++ib)
+                    for (idx it = 0; it < Dsubsys; ++it)
+                        result(bases[ib] + offsets[it], j) =
+                            rA(bases[ib] + offsets[jt],
+                               bases[jb] + offsets[it]);
+            }
 
         return result;
     }
@@ -1632,94 +1691,34 @@ syspermute(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& perm,
     //************ ket ************//
     if (internal::check_cvector(rA)) // we have a column vector
     {
-        idx Cdims[maxn];
-        idx Cperm[maxn];
-
         // check that dims match the dimension of rA
         if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchCvector("qpp::syspermute()");
 
-        // copy dims in Cdims and perm in Cperm
-        for (idx i = 0; i < n; ++i) {
-            Cdims[i] = dims[i];
-            Cperm[i] = perm[i];
-        }
         result.resize(D, 1);
-
-        auto worker = [&Cdims, &Cperm, n ](idx i) noexcept->idx {
-            // use static allocation for speed,
-            // double the size for matrices reshaped as vectors
-            idx midx[maxn];
-            idx midxtmp[maxn];
-            idx permdims[maxn];
-
-            /* compute the multi-index */
-            internal::n2multiidx(i, n, Cdims, midx);
-
-            for (idx k = 0; k < n; ++k) {
-                permdims[k] = Cdims[Cperm[k]]; // permuted dimensions
-                midxtmp[k] = midx[Cperm[k]];   // permuted multi-indexes
-            }
-
-            return internal::multiidx2n(midxtmp, n, permdims);
-        }; /* end worker */
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-        for (idx i = 0; i < D; ++i)
-            result(worker(i)) = rA(i);
+        internal::syspermute_ket(rA.data(), result.data(), perm, dims);
 
         return result;
     }
     //************ density matrix ************//
     else if (internal::check_square_mat(rA)) // we have a density operator
     {
-        idx Cdims[2 * maxn];
-        idx Cperm[2 * maxn];
-
         // check that dims match the dimension of rA
         if (!internal::check_dims_match_mat(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::syspermute()");
 
-        // copy dims in Cdims and perm in Cperm
-        for (idx i = 0; i < n; ++i) {
-            Cdims[i] = dims[i];
-            Cdims[i + n] = dims[i];
-            Cperm[i] = perm[i];
-            Cperm[i + n] = perm[i] + n;
-        }
-        result.resize(D * D, 1);
-        // map A to a column vector
-        dyn_mat<typename Derived::Scalar> vectA =
-            Eigen::Map<dyn_mat<typename Derived::Scalar>>(
-                const_cast<typename Derived::Scalar*>(rA.data()), D * D, 1);
-
-        auto worker = [&Cdims, &Cperm, n ](idx i) noexcept->idx {
-            // use static allocation for speed,
-            // double the size for matrices reshaped as vectors
-            idx midx[2 * maxn];
-            idx midxtmp[2 * maxn];
-            idx permdims[2 * maxn];
-
-            /* compute the multi-index */
-            internal::n2multiidx(i, 2 * n, Cdims, midx);
-
-            for (idx k = 0; k < 2 * n; ++k) {
-                permdims[k] = Cdims[Cperm[k]]; // permuted dimensions
-                midxtmp[k] = midx[Cperm[k]];   // permuted multi-indexes
-            }
+        // the column-major storage of rA is a ket over the 2n subsystems
+        // (columns, rows), both permuted the same way
+        std::vector<idx> dims2 = dims;
+        dims2.insert(std::end(dims2), std::begin(dims), std::end(dims));
+        std::vector<idx> perm2 = perm;
+        for (idx i = 0; i < n; ++i)
+            perm2.push_back(perm[i] + n);
 
-            return internal::multiidx2n(midxtmp, 2 * n, permdims);
-        }; /* end worker */
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-        for (idx i = 0; i < D * D; ++i)
-            result(worker(i)) = rA(i);
+        result.resize(D, D);
+        internal::syspermute_ket(rA.data(), result.data(), perm2, dims2);
 
-        return reshape(result, D, D);
+        return result;
     }
     //************ Exception: not ket nor density matrix ************//
     else
@@ -1761,6 +1760,106 @@ syspermute(const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& perm,
     return syspermute(rA, perm, dims);
 }
 
+/**
+ * \brief Subsystem permutation, as a read-only view
+ * \see qpp::syspermute()
+ *
+ * Permutes the subsystems of a state vector or density matrix, without
+ * copying it. The qubit \a perm[\a i] is permuted to the location \a i.
+ *
+ * \note The result is an Eigen expression that reads \a A through the
+ * permuted indexes, each access costing one multi-index conversion. Use it
+ * when the permuted state is only read once, e.g. in a single expression,
+ * and use qpp::syspermute() otherwise. \a A must outlive the view.
+ *
+ * \param A State vector or density matrix
+ * \param perm Permutation
+ * \param dims Dimensions of the multi-partite system
+ * \return Permuted system, as a read-only Eigen expression
+ */
+template <typename Derived>
+Eigen::CwiseNullaryOp<internal::PermutedView<typename Derived::Scalar>,
+                      dyn_mat<typename Derived::Scalar>>
+syspermute_view(const Eigen::PlainObjectBase<Derived>& A,
+                const std::vector<idx>& perm, const std::vector<idx>& dims) {
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(A))
+        throw exception::ZeroSize("qpp::syspermute_view()");
+
+    // check that dims is a valid dimension vector
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::syspermute_view()");
+
+    // check that we have a valid permutation
+    if (!internal::check_perm(perm))
+        throw exception::PermInvalid("qpp::syspermute_view()");
+
+    // check that permutation match dimensions
+    if (perm.size() != dims.size())
+        throw exception::PermMismatchDims("qpp::syspermute_view()");
+
+    //************ ket ************//
+    if (internal::check_cvector(A)) {
+        // check that dims match the dimension of A
+        if (!internal::check_dims_match_cvect(dims, A))
+            throw exception::DimsMismatchCvector("qpp::syspermute_view()");
+    }
+    //************ density matrix ************//
+    else if (internal::check_square_mat(A)) {
+        // check that dims match the dimension of A
+        if (!internal::check_dims_match_mat(dims, A))
+            throw exception::DimsMismatchMatrix("qpp::syspermute_view()");
+    }
+    //************ Exception: not ket nor density matrix ************//
+    else
+        throw exception::MatrixNotSquareNorCvector("qpp::syspermute_view()");
+    // END EXCEPTION CHECKS
+
+    return dyn_mat<typename Derived::Scalar>::NullaryExpr(
+        A.rows(), A.cols(),
+        internal::PermutedView<typename Derived::Scalar>(
+            A.data(), static_cast<idx>(A.rows()), internal::check_cvector(A),
+            perm, dims));
+}
+
+/**
+ * \brief Subsystem permutation, as a read-only view
+ * \see qpp::syspermute()
+ *
+ * Permutes the subsystems of a state vector or density matrix, without
+ * copying it. The qubit \a perm[\a i] is permuted to the location \a i.
+ *
+ * \note \a A must outlive the view, see the overload above
+ *
+ * \param A State vector or density matrix
+ * \param perm Permutation
+ * \param d Subsystem dimensions
+ * \return Permuted system, as a read-only Eigen expression
+ */
+template <typename Derived>
+Eigen::CwiseNullaryOp<internal::PermutedView<typename Derived::Scalar>,
+                      dyn_mat<typename Derived::Scalar>>
+syspermute_view(const Eigen::PlainObjectBase<Derived>& A,
+                const std::vector<idx>& perm, idx d = 2) {
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(A))
+        throw exception::ZeroSize("qpp::syspermute_view()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::syspermute_view()");
+    // END EXCEPTION CHECKS
+
+    idx n = internal::get_num_subsys(static_cast<idx>(A.rows()), d);
+    std::vector<idx> dims(n, d); // local dimensions vector
+
+    return syspermute_view(A, perm, dims);
+}
+
 // as in https://arxiv.org/abs/1707.08834
 /**
  * \brief Applies the qudit quantum Fourier transform to the part \a target of
@@ -1817,53 +1916,24 @@ dyn_mat<typename Derived::Scalar> applyQFT(const Eigen::MatrixBase<Derived>& A,
     // END EXCEPTION CHECKS
 
     dyn_mat<typename Derived::Scalar> result = rA;
+    if (target.empty())
+        return result;
 
-    idx n_subsys = target.size();
-
-    if (d == 2) // qubits
-    {
-        for (idx i = 0; i < n_subsys; ++i) {
-            // apply Hadamard on qubit i
-            result = apply(result, Gates::get_instance().H, {target[i]});
-            // apply controlled rotations
-            for (idx j = 2; j <= n_subsys - i; ++j) {
-                // construct Rj
-                cmat Rj(2, 2);
-                Rj << 1, 0, 0, exp(2.0 * pi * 1_i / std::pow(2, j));
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]});
-            }
-        }
-        if (swap) {
-            // we have the qubits in reversed order, we must swap them
-            for (idx i = 0; i < n_subsys / 2; ++i) {
-                result = apply(result, Gates::get_instance().SWAP,
-                               {target[i], target[n_subsys - i - 1]});
-            }
-        }
-
-    } else { // qudits
-        for (idx i = 0; i < n_subsys; ++i) {
-            // apply qudit Fourier on qudit i
-            result = apply(result, Gates::get_instance().Fd(d), {target[i]}, d);
-            // apply controlled rotations
-            for (idx j = 2; j <= n_subsys - i; ++j) {
-                // construct Rj
-                cmat Rj = cmat::Zero(d, d);
-                for (idx m = 0; m < d; ++m) {
-                    Rj(m, m) = exp(2.0 * pi * m * 1_i / std::pow(d, j));
-                }
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]}, d);
-            }
-        }
-        if (swap) {
-            // we have the qudits in reversed order, we must swap them
-            for (idx i = 0; i < n_subsys / 2; ++i) {
-                result = apply(result, Gates::get_instance().SWAPd(d),
-                               {target[i], target[n_subsys - i - 1]}, d);
-            }
-        }
+    // one fused pass per target subsystem, see internal/kernels.h
+    if (internal::check_cvector(rA)) {
+        internal::apply_qft_ket_inplace(result, target, dims, false, swap);
+    } else {
+        // same two passes as for qpp::applyCTRL(), the conjugate transform
+        // acts on the column subsystems
+        std::vector<idx> dims2 = dims;
+        dims2.insert(std::end(dims2), std::begin(dims), std::end(dims));
+        std::vector<idx> target_rows = target;
+        for (auto&& elem : target_rows)
+            elem += n;
+        internal::apply_qft_ket_inplace(result, target_rows, dims2, false,
+                                        swap);
+        internal::apply_qft_ket_inplace(result, target, dims2, false, swap,
+                                        true);
     }
 
     return result;
@@ -1925,53 +1995,24 @@ dyn_mat<typename Derived::Scalar> applyTFQ(const Eigen::MatrixBase<Derived>& A,
     // END EXCEPTION CHECKS
 
     dyn_mat<typename Derived::Scalar> result = rA;
+    if (target.empty())
+        return result;
 
-    idx n_subsys = target.size();
-
-    if (d == 2) // qubits
-    {
-        if (swap) {
-            // we have the qubits in reversed order, we must swap them
-            for (idx i = 0; i < n_subsys / 2; ++i) {
-                result = apply(result, Gates::get_instance().SWAP,
-                               {target[i], target[n_subsys - i - 1]});
-            }
-        }
-        for (idx i = n_subsys; i-- > 0;) {
-            // apply controlled rotations
-            for (idx j = n_subsys - i + 1; j-- > 2;) {
-                // construct Rj
-                cmat Rj(2, 2);
-                Rj << 1, 0, 0, exp(-2.0 * pi * 1_i / std::pow(2, j));
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]});
-            }
-            // apply Hadamard on qubit i
-            result = apply(result, Gates::get_instance().H, {target[i]});
-        }
-    } else { // qudits
-        if (swap) {
-            // we have the qudits in reversed order, we must swap them
-            for (idx i = 0; i < n_subsys / 2; ++i) {
-                result = apply(result, Gates::get_instance().SWAPd(d),
-                               {target[i], target[n_subsys - i - 1]}, d);
-            }
-        }
-        for (idx i = n_subsys; i-- > 0;) {
-            // apply controlled rotations
-            for (idx j = n_subsys - i + 1; j-- > 2;) {
-                // construct Rj
-                cmat Rj = cmat::Zero(d, d);
-                for (idx m = 0; m < d; ++m) {
-                    Rj(m, m) = exp(-2.0 * pi * m * 1_i / std::pow(d, j));
-                }
-                result =
-                    applyCTRL(result, Rj, {target[i + j - 1]}, {target[i]}, d);
-            }
-            // apply qudit Fourier on qudit i
-            result = apply(result, adjoint(Gates::get_instance().Fd(d)),
-                           {target[i]}, d);
-        }
+    // one fused pass per target subsystem, see internal/kernels.h
+    if (internal::check_cvector(rA)) {
+        internal::apply_qft_ket_inplace(result, target, dims, true, swap);
+    } else {
+        // same two passes as for qpp::applyCTRL(), the conjugate transform
+        // acts on the column subsystems
+        std::vector<idx> dims2 = dims;
+        dims2.insert(std::end(dims2), std::begin(dims), std::end(dims));
+        std::vector<idx> target_rows = target;
+        for (auto&& elem : target_rows)
+            elem += n;
+        internal::apply_qft_ket_inplace(result, target_rows, dims2, true,
+                                        swap);
+        internal::apply_qft_ket_inplace(result, target, dims2, true, swap,
+                                        true);
     }
 
     return result;
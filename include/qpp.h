@@ -52,6 +52,7 @@
 #include <chrono>
 #include <cmath>
 #include <complex>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
@@ -61,7 +62,9 @@
 #include <iomanip>
 #include <iterator>
 #include <limits>
+#include <map>
 #include <memory>
+#include <new>
 #include <numeric>
 #include <ostream>
 #include <random>
@@ -73,9 +76,19 @@
 #include <utility>
 #include <vector>
 
+// POSIX memory mapping, used by qpp::MappedKetT
+#if defined(__unix__) || defined(__APPLE__)
+#define QPP_HAS_MMAP_
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // Eigen headers
 #include <Eigen/Dense>
 #include <Eigen/SVD>
+#include <Eigen/Sparse>
 
 // Quantum++ headers
 
@@ -86,6 +99,8 @@
 #include "traits.h"
 #include "classes/idisplay.h"
 #include "internal/util.h"
+#include "internal/classes/index_plan.h"
+#include "internal/kernels.h"
 #include "internal/classes/iomanip.h"
 #include "input_output.h"
 
@@ -113,6 +128,7 @@
 #include "instruments.h"
 #include "classes/reversible.h"
 #include "classes/noise.h"
+#include "classes/mapped_ket.h"
 #include "classes/circuits.h"
 
 /**
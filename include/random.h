@@ -169,9 +169,16 @@ inline dmat rand(idx rows, idx cols, double a, double b) {
         throw exception::OutOfRange("qpp::rand()");
     // END EXCEPTION CHECKS
 
-    return dmat::Zero(rows, cols).unaryExpr([a, b](double) {
-        return rand(a, b);
-    });
+    dmat result(rows, cols);
+#ifdef NO_THREAD_LOCAL_
+    RandomDevices::get_instance()
+#else
+    RandomDevices::get_thread_local_instance()
+#endif
+        .get_counter_based_prng()
+        .fill_uniform(result.data(), rows * cols, a, b);
+
+    return result;
 }
 
 /**
@@ -205,8 +212,18 @@ inline cmat rand(idx rows, idx cols, double a, double b) {
         throw exception::OutOfRange("qpp::rand()");
     // END EXCEPTION CHECKS
 
-    return rand<dmat>(rows, cols, a, b).cast<cplx>() +
-           1_i * rand<dmat>(rows, cols, a, b).cast<cplx>();
+    // the real and imaginary parts are consecutive doubles
+    cmat result(rows, cols);
+#ifdef NO_THREAD_LOCAL_
+    RandomDevices::get_instance()
+#else
+    RandomDevices::get_thread_local_instance()
+#endif
+        .get_counter_based_prng()
+        .fill_uniform(reinterpret_cast<double*>(result.data()),
+                      2 * rows * cols, a, b);
+
+    return result;
 }
 
 /**
@@ -259,17 +276,16 @@ inline dmat randn(idx rows, idx cols, double mean, double sigma) {
         throw exception::ZeroSize("qpp::randn()");
     // END EXCEPTION CHECKS
 
-    std::normal_distribution<> nd(mean, sigma);
-    auto& gen =
+    dmat result(rows, cols);
 #ifdef NO_THREAD_LOCAL_
-        RandomDevices::get_instance().get_prng();
+    RandomDevices::get_instance()
 #else
-        RandomDevices::get_thread_local_instance().get_prng();
+    RandomDevices::get_thread_local_instance()
 #endif
+        .get_counter_based_prng()
+        .fill_normal(result.data(), rows * cols, mean, sigma);
 
-    return dmat::Zero(rows, cols).unaryExpr([&nd, &gen](double) {
-        return nd(gen);
-    });
+    return result;
 }
 
 /**
@@ -301,8 +317,18 @@ inline cmat randn(idx rows, idx cols, double mean, double sigma) {
         throw exception::ZeroSize("qpp::randn()");
     // END EXCEPTION CHECKS
 
-    return randn<dmat>(rows, cols, mean, sigma).cast<cplx>() +
-           1_i * randn<dmat>(rows, cols, mean, sigma).cast<cplx>();
+    // the real and imaginary parts are consecutive doubles
+    cmat result(rows, cols);
+#ifdef NO_THREAD_LOCAL_
+    RandomDevices::get_instance()
+#else
+    RandomDevices::get_thread_local_instance()
+#endif
+        .get_counter_based_prng()
+        .fill_normal(reinterpret_cast<double*>(result.data()),
+                     2 * rows * cols, mean, sigma);
+
+    return result;
 }
 
 /**
@@ -325,6 +351,37 @@ inline double randn(double mean = 0, double sigma = 1) {
     return nd(gen);
 }
 
+/**
+ * \brief Generates a random isometry matrix
+ *
+ * The isometry is distributed as the first \a Din columns of a random
+ * unitary (Haar measure), and obtained from the thin QR decomposition of a
+ * \a Dout x \a Din Gaussian matrix, in \f$O(D_{out} D_{in}^2)\f$ time.
+ *
+ * \param Din Size of the input Hilbert space
+ * \param Dout Size of the output Hilbert space
+ * \return Random isometry matrix
+ */
+inline cmat randV(idx Din, idx Dout) {
+    // EXCEPTION CHECKS
+
+    if (Din == 0 || Dout == 0 || Din > Dout)
+        throw exception::DimsInvalid("qpp::randV()");
+    // END EXCEPTION CHECKS
+
+    Eigen::HouseholderQR<cmat> qr(randn<cmat>(Dout, Din));
+    // the reflectors are applied to the first Din columns only
+    cmat Q = qr.householderQ() * cmat::Identity(Dout, Din);
+
+    // phase correction so that the resultant matrix is
+    // uniformly distributed according to the Haar measure
+    dmat phases = rand<dmat>(Din, 1);
+    for (idx i = 0; i < Din; ++i)
+        Q.col(i) *= std::exp(2 * pi * 1_i * phases(i));
+
+    return Q;
+}
+
 /**
  * \brief Generates a random unitary matrix
  *
@@ -341,37 +398,44 @@ inline cmat randU(idx D = 2)
         throw exception::DimsInvalid("qpp::randU()");
     // END EXCEPTION CHECKS
 
-    cmat X = 1 / std::sqrt(2.) * randn<cmat>(D, D);
-    Eigen::HouseholderQR<cmat> qr(X);
-
-    cmat Q = qr.householderQ();
-    // phase correction so that the resultant matrix is
-    // uniformly distributed according to the Haar measure
-
-    Eigen::VectorXcd phases = (rand<dmat>(D, 1)).cast<cplx>();
-    for (idx i = 0; i < static_cast<idx>(phases.rows()); ++i)
-        phases(i) = std::exp(2 * pi * 1_i * phases(i));
-
-    Q = Q * phases.asDiagonal();
-
-    return Q;
+    return randV(D, D);
 }
 
 /**
- * \brief Generates a random isometry matrix
+ * \brief Generates a batch of independent random unitary matrices
  *
- * \param Din Size of the input Hilbert space
- * \param Dout Size of the output Hilbert space
- * \return Random isometry matrix
+ * The Gaussian matrices of the whole batch are generated at once, then the
+ * unitaries are computed in parallel, one per thread.
+ *
+ * \param n Number of unitaries
+ * \param D Dimension of the Hilbert space
+ * \return Vector of \a n random unitaries
  */
-inline cmat randV(idx Din, idx Dout) {
+inline std::vector<cmat> randU_batch(idx n, idx D = 2) {
     // EXCEPTION CHECKS
 
-    if (Din == 0 || Dout == 0 || Din > Dout)
-        throw exception::DimsInvalid("qpp::randV()");
+    if (n == 0)
+        throw exception::OutOfRange("qpp::randU_batch()");
+    if (D == 0)
+        throw exception::DimsInvalid("qpp::randU_batch()");
     // END EXCEPTION CHECKS
 
-    return randU(Dout).block(0, 0, Dout, Din);
+    cmat X = randn<cmat>(D, n * D);
+    dmat phases = rand<dmat>(D, n);
+    std::vector<cmat> result(n);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx k = 0; k < n; ++k) {
+        Eigen::HouseholderQR<cmat> qr(X.middleCols(k * D, D));
+        result[k] = qr.householderQ();
+        // phase correction, see qpp::randV()
+        for (idx i = 0; i < D; ++i)
+            result[k].col(i) *= std::exp(2 * pi * 1_i * phases(i, k));
+    }
+
+    return result;
 }
 
 /**
@@ -397,8 +461,8 @@ inline std::vector<cmat> randkraus(idx N, idx D = 2) {
     for (idx i = 0; i < N; ++i)
         result[i] = cmat::Zero(D, D);
 
-    cmat Fk(D, D);
-    cmat U = randU(N * D);
+    // the Kraus operators are the blocks of a random isometry
+    cmat V = randV(D, N * D);
 
 #ifdef WITH_OPENMP_
 #pragma omp parallel for collapse(3)
@@ -406,7 +470,7 @@ inline std::vector<cmat> randkraus(idx N, idx D = 2) {
     for (idx k = 0; k < N; ++k)
         for (idx a = 0; a < D; ++a)
             for (idx b = 0; b < D; ++b)
-                result[k](a, b) = U(a * N + k, b * N);
+                result[k](a, b) = V(a * N + k, b);
 
     return result;
 }
@@ -145,6 +145,17 @@ struct is_complex<std::complex<T>> : std::true_type {};
 #pragma GCC diagnostic pop
 #endif
 
+/**
+ * \brief Scalar field of the states obtained from a state over the field
+ * \a Scalar, e.g. of the post-measurement states
+ *
+ * Complex fields keep their precision, i.e. single precision states stay in
+ * single precision, any other field is promoted to qpp::cplx
+ */
+template <typename Scalar>
+using state_scalar_t =
+    typename std::conditional<is_complex<Scalar>::value, Scalar, cplx>::type;
+
 } /* namespace qpp */
 
 #endif /* TRAITS_H_ */
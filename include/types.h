@@ -68,6 +68,35 @@ using cmat = Eigen::MatrixXcd;
  */
 using dmat = Eigen::MatrixXd;
 
+/**
+ * \brief Complex number in single precision
+ */
+using cplx_f = std::complex<float>;
+
+/**
+ * \brief Complex (single precision) dynamic Eigen column vector
+ *
+ * Half the memory of qpp::ket per amplitude, can be used wherever a state
+ * vector is expected; gates, Kraus operators etc. stay in double precision
+ * and are converted to single precision when applied
+ */
+using ket_f = Eigen::VectorXcf;
+
+/**
+ * \brief Complex (single precision) dynamic Eigen row vector
+ */
+using bra_f = Eigen::RowVectorXcf;
+
+/**
+ * \brief Complex (single precision) dynamic Eigen matrix
+ */
+using cmat_f = Eigen::MatrixXcf;
+
+/**
+ * \brief Complex (double precision) sparse Eigen matrix
+ */
+using sparse_cmat = Eigen::SparseMatrix<cplx>;
+
 /**
  * \brief Dynamic Eigen matrix over the field specified by \a Scalar
  *
@@ -104,6 +133,18 @@ using dyn_col_vect = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
 template <typename Scalar> // Eigen::RowVectorX_type (where type = Scalar)
 using dyn_row_vect = Eigen::Matrix<Scalar, 1, Eigen::Dynamic>;
 
+/**
+ * \brief Sparse Eigen matrix over the field specified by \a Scalar
+ *
+ * Example:
+ * \code
+ * // type of mat is Eigen::SparseMatrix<float>
+ * dyn_sparse_mat<float> mat(2, 3);
+ * \endcode
+ */
+template <typename Scalar> // Eigen::SparseMatrix<type> (where type = Scalar)
+using dyn_sparse_mat = Eigen::SparseMatrix<Scalar>;
+
 } /* namespace qpp */
 
 #endif /* TYPES_H_ */
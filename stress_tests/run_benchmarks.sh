@@ -0,0 +1,23 @@
+#!/bin/bash
+
+NUM_CORES=8                      # number of cores
+NQ_START=2                       # number of qubits to start with
+NQ_END=24                        # number of qubits to end with
+NQ_END_DENSITY=12                # same, for the density matrix workload
+DATE=`date '+%Y-%m-%d_%H-%M-%S'` # current date
+OUT_FILE=benchmarks_$DATE.csv    # results output file
+
+echo "Benchmark suite, see benchmarks_$DATE.csv"
+echo "workload num_cores num_qubits time_seconds bandwidth_GBps"
+echo "workload, numcores, nqubits, time_seconds, bandwidth_GBps" > $OUT_FILE
+for ((numcores=1; numcores <= NUM_CORES; numcores++));
+do
+    for ((n=NQ_START; n <= NQ_END; n++));
+    do
+        ./build/benchmarks $numcores $n | tee -a $OUT_FILE
+    done;
+    for ((n=NQ_START; n <= NQ_END_DENSITY; n++));
+    do
+        ./build/benchmarks $numcores $n density | tee -a $OUT_FILE
+    done;
+done;
@@ -0,0 +1,227 @@
+// Benchmark suite, representative workloads on n qubits
+// Usage: ./build/benchmarks num_cores n [workload ...], runs all state vector
+// workloads if none is specified (the density matrix workload must be named
+// explicitly, as it needs the square of the memory)
+// Prints one line per workload
+// workload, num_cores, num_qubits, time_seconds, bandwidth_GBps
+// where the bandwidth is the nominal memory traffic, one read and one write of
+// the whole state per gate or measurement, divided by the time
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <omp.h>
+
+#include "qpp.h"
+
+using namespace qpp;
+
+// time in seconds and number of passes over the state
+using Measurement = std::pair<double, double>;
+
+// number of passes over the state needed to execute the circuit
+double sweeps(const QCircuit& qc) {
+    double result = static_cast<double>(qc.get_measurement_count());
+    for (auto&& elem : qc.get_gates()) {
+        idx m = elem.target_.size();
+        switch (elem.gate_type_) {
+        case QCircuit::GateType::FAN:
+            result += m;
+            break;
+        case QCircuit::GateType::QFT:
+        case QCircuit::GateType::TFQ:
+            result += m * (m + 1) / 2 + (elem.swap_ ? m / 2 : 0);
+            break;
+        default:
+            result += 1;
+            break;
+        }
+    }
+
+    return result;
+}
+
+// random single qubit gates on all qubits, followed by random two qubit gates
+// on neighbouring pairs, starting with the pair (qubits[offset],
+// qubits[offset + 1])
+void random_layer(QCircuit& qc, const std::vector<idx>& qubits, idx offset) {
+    std::vector<cmat> Us = randU_batch(qubits.size());
+    for (idx i = 0; i < qubits.size(); ++i)
+        qc.gate(Us[i], qubits[i]);
+    for (idx i = offset; i + 1 < qubits.size(); i += 2)
+        qc.gate(randU(4), qubits[i], qubits[i + 1]);
+}
+
+QCircuit random_circuit(idx n, idx depth) {
+    QCircuit qc{n};
+    std::vector<idx> qubits(n);
+    std::iota(std::begin(qubits), std::end(qubits), 0);
+    for (idx layer = 0; layer < depth; ++layer)
+        random_layer(qc, qubits, layer % 2);
+
+    return qc;
+}
+
+// runs the circuit once on a double precision state vector
+Measurement run_circuit(const QCircuit& qc) {
+    QEngine engine{qc};
+    Timer<> t;
+    engine.run();
+
+    return {t.toc().tics(), sweeps(qc)};
+}
+
+Measurement random_circuit_bench(idx n) {
+    QCircuit qc = random_circuit(n, 10);
+
+    return run_circuit(qc);
+}
+
+Measurement ghz(idx n) {
+    QCircuit qc{n};
+    qc.gate(gt.H, 0);
+    for (idx i = 0; i + 1 < n; ++i)
+        qc.CTRL(gt.X, i, i + 1);
+
+    return run_circuit(qc);
+}
+
+Measurement qft(idx n) {
+    QCircuit qc{n};
+    std::vector<idx> target(n);
+    std::iota(std::begin(target), std::end(target), 0);
+    qc.gate_fan(gt.H);
+    qc.QFT(target);
+
+    return run_circuit(qc);
+}
+
+// at most 10 iterations, so that the time grows with the size of the state
+// only
+Measurement grover(idx n) {
+    idx D = static_cast<idx>(std::llround(std::pow(2, n)));
+    std::vector<idx> target(n);
+    std::iota(std::begin(target), std::end(target), 0);
+
+    ket oracle = ket::Ones(D);
+    oracle(D - 1) = -1; // marked element
+    ket diffusion = -ket::Ones(D);
+    diffusion(0) = 1;
+
+    QCircuit qc{n};
+    qc.gate_fan(gt.H);
+    idx iterations = std::min<idx>(
+        10, static_cast<idx>(std::floor(pi / 4 * std::sqrt(D))));
+    for (idx i = 0; i < std::max<idx>(iterations, 1); ++i) {
+        qc.gate_diag(oracle, target);
+        qc.gate_fan(gt.H);
+        qc.gate_diag(diffusion, target);
+        qc.gate_fan(gt.H);
+    }
+
+    return run_circuit(qc);
+}
+
+// GHZ state, then up to 4 rounds of measuring one qubit and applying a random
+// layer on the remaining ones
+Measurement mid_circuit(idx n) {
+    QCircuit qc{n, n};
+    qc.gate(gt.H, 0);
+    for (idx i = 0; i + 1 < n; ++i)
+        qc.CTRL(gt.X, i, i + 1);
+    for (idx k = 0; k < std::min<idx>(n - 1, 4); ++k) {
+        qc.measureZ(k, k);
+        std::vector<idx> qubits(n - k - 1);
+        std::iota(std::begin(qubits), std::end(qubits), k + 1);
+        random_layer(qc, qubits, k % 2);
+    }
+
+    return run_circuit(qc);
+}
+
+// 8 trajectories of a depolarized random circuit, distributed across threads;
+// each noise element other than the identity costs one more pass
+Measurement noisy(idx n) {
+    const double p = 0.01;
+    const idx shots = 8;
+    QCircuit qc = random_circuit(n, 4);
+    QNoisyEngine<QubitDepolarizingNoise> engine{qc,
+                                                QubitDepolarizingNoise{p}};
+    Timer<> t;
+    engine.run(shots);
+
+    return {t.toc().tics(),
+            shots * (sweeps(qc) + p * n * qc.get_gate_count())};
+}
+
+// random circuit applied to a density matrix, the bandwidth is reported in
+// terms of the density matrix
+Measurement density(idx n) {
+    idx D = static_cast<idx>(std::llround(std::pow(2, n)));
+    QCircuit qc = random_circuit(n, 4);
+    cmat rho = cmat::Zero(D, D);
+    rho(0, 0) = 1;
+
+    Timer<> t;
+    for (auto&& elem : qc.get_gates())
+        rho = apply(rho, elem.gate_, elem.target_);
+
+    return {t.toc().tics(), D * sweeps(qc)};
+}
+
+int main(int argc, char** argv) {
+    const std::vector<
+        std::pair<std::string, std::function<Measurement(idx)>>>
+        workloads{{"random", random_circuit_bench},
+                  {"ghz", ghz},
+                  {"qft", qft},
+                  {"grover", grover},
+                  {"mid_circuit", mid_circuit},
+                  {"noisy", noisy},
+                  {"density", density}};
+
+    if (argc < 3) {
+        std::cerr << "Please specify the number of cores and qubits!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    idx num_cores = std::stoi(argv[1]); // number of cores
+    idx n = std::stoi(argv[2]);         // number of qubits
+    omp_set_num_threads(num_cores);     // number of cores
+    if (n < 2) {
+        std::cerr << "The benchmarks need at least 2 qubits!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<std::string> names(argv + 3, argv + argc);
+    if (names.empty()) // all state vector workloads
+        for (auto&& elem : workloads)
+            if (elem.first != "density")
+                names.emplace_back(elem.first);
+
+    // size in bytes of the state vector
+    double state_bytes = std::pow(2., n) * sizeof(cplx);
+    for (auto&& name : names) {
+        auto it = std::find_if(
+            std::begin(workloads), std::end(workloads),
+            [&name](const std::pair<std::string,
+                                    std::function<Measurement(idx)>>& elem) {
+                return elem.first == name;
+            });
+        if (it == std::end(workloads)) {
+            std::cerr << "Unknown workload: " << name << '\n';
+            exit(EXIT_FAILURE);
+        }
+
+        Measurement m = it->second(n);
+        double bandwidth = 2 * m.second * state_bytes / m.first / 1e9;
+        std::cout << name << ", " << num_cores << ", " << n << ", " << m.first
+                  << ", " << bandwidth << '\n';
+    }
+}
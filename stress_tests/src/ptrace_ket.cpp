@@ -0,0 +1,33 @@
+// Partial trace stress test on a pure state of n qubits
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "qpp.h"
+
+int main(int argc, char **argv) {
+    using namespace qpp;
+    if (argc != 3) {
+        std::cerr << "Please specify the number of cores and qubits!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    idx num_cores = std::stoi(argv[1]); // number of cores
+    idx n = std::stoi(argv[2]);         // number of qubits
+    idx D = std::round(std::pow(2, n)); // dimension
+    omp_set_num_threads(num_cores);     // number of cores
+
+    ket psi = randket(D); // random state vector
+    // partial trace over all qubits but the first one
+    std::vector<idx> subsys_ptrace(n - 1);
+    std::iota(std::begin(subsys_ptrace), std::end(subsys_ptrace), 1);
+
+    Timer<> t; // start timing
+    ptrace(psi, subsys_ptrace);
+    std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
+}
@@ -2,6 +2,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -24,19 +25,11 @@ int main(int argc, char **argv) {
     ket psi = mket(qubits);
     ket result = psi;
 
+    std::vector<idx> target(n); // QFT on all qubits
+    std::iota(std::begin(target), std::end(target), 0);
+
     Timer<> t; // start timing
-    for (idx i = 0; i < n; ++i) {
-        result = apply(result, gt.H, {i}); // apply Hadamard on qubit i
-        // apply controlled rotations
-        for (idx j = 2; j <= n - i; ++j) {
-            cmat Rj(2, 2);
-            Rj << 1, 0, 0, omega(std::pow(2, j));
-            result = applyCTRL(result, Rj, {i + j - 1}, {i});
-        }
-    }
-    // we have the qubits in reversed order, we must swap them
-    for (idx i = 0; i < n / 2; ++i) {
-        result = apply(result, gt.SWAP, {i, n - i - 1});
-    }
+    // one pass over the state per qubit, swaps included
+    result = applyQFT(result, target);
     std::cout << num_cores << ", " << n << ", " << t.toc() << '\n';
 }
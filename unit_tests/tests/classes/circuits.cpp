@@ -0,0 +1,321 @@
+/*
+ * This file is part of Quantum++.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2013 - 2019 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/circuits.h"
+
+/******************************************************************************/
+/// BEGIN QCircuit qpp::QCircuit::fuse(idx max_width = 4) const
+TEST(qpp_QCircuit_fuse, AllTests) {
+    // qubits
+    QCircuit qc{4, 1};
+    qc.gate(gt.X, 0).CTRL(gt.X, 0, 1).gate(gt.T, 1).gate(gt.H, 2);
+    qc.CTRL(gt.Z, {1, 2}, 3).gate_fan(gt.X, {0, 3}).measureZ(0, 0);
+    qc.gate(gt.RY(0.3), 1).cCTRL(gt.X, 0, 2).gate(gt.S, 2).gate(gt.H, 3);
+
+    QCircuit fused = qc.fuse(3);
+    // {H, CTRL, T, H} {CTRL, FAN} | measureZ | {RY} | cCTRL | {S, H}
+    EXPECT_EQ(6u, fused.get_gate_count());
+    EXPECT_EQ(qc.get_measurement_count(), fused.get_measurement_count());
+
+    QEngine q_engine{qc};
+    QEngine q_engine_fused{fused};
+    for (auto&& elem : qc)
+        q_engine.execute(elem);
+    for (auto&& elem : fused)
+        q_engine_fused.execute(elem);
+    // the measured qubit is in the state |0> before measurement
+    EXPECT_EQ(std::vector<idx>{0}, q_engine_fused.get_dits());
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - q_engine_fused.get_psi()),
+                1e-7);
+
+    // qutrits, no measurements
+    QCircuit qc3{3, 0, 3};
+    qc3.gate(gt.Fd(3), 0).CTRL(gt.Xd(3), 0, 2).gate(randU(9), 1, 2);
+    qc3.gate(gt.Zd(3), 1).CTRL(randU(3), {0, 1}, 2);
+    QCircuit fused3 = qc3.fuse();
+    EXPECT_EQ(1u, fused3.get_gate_count());
+
+    QEngine q_engine3{qc3};
+    QEngine q_engine3_fused{fused3};
+    for (auto&& elem : qc3)
+        q_engine3.execute(elem);
+    for (auto&& elem : fused3)
+        q_engine3_fused.execute(elem);
+    EXPECT_NEAR(0, norm(q_engine3.get_psi() - q_engine3_fused.get_psi()),
+                1e-7);
+
+    // gates wider than max_width are copied as is
+    EXPECT_EQ(qc3.get_gate_count(), qc3.fuse(1).get_gate_count());
+}
+/******************************************************************************/
+/// BEGIN QCircuit qpp::QCircuit::fuse_diag(idx max_width = 16) const
+TEST(qpp_QCircuit_fuse_diag, AllTests) {
+    // qubits, QFT-like circuit
+    QCircuit qc{4, 0};
+    qc.gate_fan(gt.H).CTRL(gt.Z, 0, 1).CTRL(gt.T, {0, 1}, 2).gate(gt.S, 3);
+    qc.gate_fan(gt.Z, {1, 2}).gate_diag(randket(4), {3, 0}).gate(gt.H, 1);
+    qc.CTRL(gt.RZ(0.3), 1, 0).gate(gt.T, 2);
+
+    QCircuit fused = qc.fuse_diag();
+    // FAN | {CTRL-Z, CTRL-T, S, FAN-Z, DIAG} | H | {CTRL-RZ, T}
+    EXPECT_EQ(4u, fused.get_gate_count());
+    // the merged diagonal gates are not wider than max_width
+    EXPECT_EQ(6u, qc.fuse_diag(3).get_gate_count());
+
+    QEngine q_engine{qc};
+    QEngine q_engine_fused{fused};
+    QCircuit fused_dense = fused.fuse(2);
+    QEngine q_engine_fused_dense{fused_dense};
+    for (auto&& elem : qc)
+        q_engine.execute(elem);
+    for (auto&& elem : fused)
+        q_engine_fused.execute(elem);
+    for (auto&& elem : fused_dense)
+        q_engine_fused_dense.execute(elem);
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - q_engine_fused.get_psi()),
+                1e-7);
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - q_engine_fused_dense.get_psi()),
+                1e-7);
+
+    // qutrits, controlled diagonal gate
+    QCircuit qc3{3, 0, 3};
+    qc3.gate_fan(gt.Fd(3)).CTRL(gt.Zd(3), 0, 1).gate(gt.Zd(3), 2);
+    qc3.CTRL(gt.Zd(3), {1, 2}, 0);
+    QCircuit fused3 = qc3.fuse_diag();
+    EXPECT_EQ(2u, fused3.get_gate_count());
+
+    QEngine q_engine3{qc3};
+    QEngine q_engine3_fused{fused3};
+    for (auto&& elem : qc3)
+        q_engine3.execute(elem);
+    for (auto&& elem : fused3)
+        q_engine3_fused.execute(elem);
+    EXPECT_NEAR(0, norm(q_engine3.get_psi() - q_engine3_fused.get_psi()),
+                1e-7);
+}
+/******************************************************************************/
+/// BEGIN std::map<std::vector<idx>, idx> qpp::QEngine::run(idx shots = 1)
+TEST(qpp_QEngine_run, AllTests) {
+    idx shots = 1000;
+
+    // terminal measurements, Bell state measured in the Z and X bases
+    QCircuit qc{3, 3};
+    qc.gate(gt.H, 0).CTRL(gt.X, 0, 1).gate(gt.X, 2).gate(gt.H, 2);
+    qc.measureZ(0, 0).measureZ(1, 1).measureV(gt.H, 2, 2);
+    QEngine q_engine{qc};
+    std::map<std::vector<idx>, idx> hist = q_engine.run(shots);
+    idx total = 0;
+    for (auto&& elem : hist) {
+        // the Z outcomes are correlated, qubit 2 is in the state |->
+        EXPECT_EQ(elem.first[0], elem.first[1]);
+        EXPECT_EQ(1u, elem.first[2]);
+        total += elem.second;
+    }
+    EXPECT_EQ(shots, total);
+    EXPECT_EQ(2u, hist.size());
+    // the state is the one right before the measurements
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - kron(st.b00, st.x1)), 1e-7);
+
+    // mid-circuit measurement fed forward, deterministic teleportation of |1>
+    QCircuit qc_ff{3, 2};
+    qc_ff.gate(gt.X, 0).gate(gt.H, 1).CTRL(gt.X, 1, 2).CTRL(gt.X, 0, 1);
+    qc_ff.gate(gt.H, 0).measureZ(0, 0).measureZ(1, 1);
+    qc_ff.cCTRL(gt.X, 1, 2).cCTRL(gt.Z, 0, 2);
+    QEngine q_engine_ff{qc_ff};
+    hist = q_engine_ff.run(100);
+    total = 0;
+    for (auto&& elem : hist)
+        total += elem.second;
+    EXPECT_EQ(100u, total);
+    EXPECT_NEAR(0, norm(q_engine_ff.get_psi() - st.z1), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN std::map<std::vector<idx>, idx> qpp::QEngine::run_batch(
+///       idx shots, std::mt19937::result_type seed) const
+TEST(qpp_QEngine_run_batch, AllTests) {
+    idx shots = 1000;
+
+    // mid-circuit measurement fed forward, the dits 0 and 2 are equal
+    QCircuit qc{3, 3};
+    qc.gate(gt.H, 0).gate(gt.H, 1).measureZ(0, 0).cCTRL(gt.X, 0, 2);
+    qc.measureZ(1, 1).measureZ(2, 2);
+    QEngine q_engine{qc};
+    std::map<std::vector<idx>, idx> hist = q_engine.run_batch(shots, 42);
+    idx total = 0;
+    for (auto&& elem : hist) {
+        EXPECT_EQ(elem.first[0], elem.first[2]);
+        total += elem.second;
+    }
+    EXPECT_EQ(shots, total);
+    EXPECT_EQ(4u, hist.size());
+
+    // the same master seed gives the same histogram
+    EXPECT_EQ(hist, q_engine.run_batch(shots, 42));
+
+    // noisy trajectories
+    QNoisyEngine<QubitBitFlipNoise> q_noisy_engine{qc, QubitBitFlipNoise{0.1}};
+    EXPECT_EQ(q_noisy_engine.run_batch(shots, 7),
+              q_noisy_engine.run_batch(shots, 7));
+}
+/******************************************************************************/
+/// BEGIN void qpp::QEngine::execute(
+///       const QCircuit::iterator::value_type& elem)
+TEST(qpp_QEngine_execute, AllTests) {
+    // qutrits, gate powers selected by the classical dit
+    QCircuit qc{2, 1, 3};
+    qc.cCTRL(gt.Xd(3), 0, 0).CTRL(gt.Xd(3), 0, 1);
+    QEngine q_engine{qc};
+
+    // X^2 |0> = |2>, then the control in |2> applies X^2 on the target
+    q_engine.set_dit(0, 2);
+    for (auto&& elem : qc)
+        q_engine.execute(elem);
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - mket({2, 2}, 3)), 1e-7);
+
+    // repeated execution reuses the cached powers
+    q_engine.reset();
+    q_engine.set_dit(0, 1);
+    for (auto&& elem : qc)
+        q_engine.execute(elem);
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - mket({1, 1}, 3)), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN QCircuit& qpp::QCircuit::CTRL_perm(const std::vector<idx>& perm,
+///       const std::vector<idx>& ctrl, const std::vector<idx>& target,
+///       std::string name = "")
+TEST(qpp_QCircuit_CTRL_perm, AllTests) {
+    // controlled multiplication by 7 mod 15 of |1>, then by 4 mod 15
+    QCircuit qc{5, 0};
+    qc.gate(gt.X, 0).gate(gt.X, 4);
+    qc.CTRL_perm(gt.MODMUL_perm(7, 15, 4), {0}, {1, 2, 3, 4});
+    qc.gate_perm(gt.MODMUL_perm(4, 15, 4), {1, 2, 3, 4});
+    QEngine q_engine{qc};
+    for (auto&& elem : qc)
+        q_engine.execute(elem);
+    // 28 mod 15 = 13
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - mket({1, 1, 1, 0, 1})), 1e-7);
+
+    // not a permutation
+    EXPECT_THROW(qc.gate_perm({0, 0}, {0}), exception::PermInvalid);
+}
+/******************************************************************************/
+/// BEGIN QCircuit& qpp::QCircuit::QFT(const std::vector<idx>& target,
+///       bool swap = true)
+TEST(qpp_QCircuit_QFT, AllTests) {
+    // qubits, QFT followed by TFQ on another ordering of the same qubits
+    QCircuit qc{4, 0};
+    qc.gate_fan(gt.H).gate(gt.T, 1).QFT({3, 0, 1}).TFQ({1, 2}, false);
+    EXPECT_EQ(4u, qc.get_gate_count());
+    QEngine q_engine{qc};
+    for (auto&& elem : qc)
+        q_engine.execute(elem);
+    ket psi = applyQFT(apply(st.plus(4), gt.T, {1}), {3, 0, 1});
+    psi = applyTFQ(psi, {1, 2}, 2, false);
+    EXPECT_NEAR(0, norm(q_engine.get_psi() - psi), 1e-7);
+
+    // qutrits, the QFT of |0> is the uniform superposition
+    QCircuit qc3{2, 0, 3};
+    qc3.QFT({1, 0});
+    QEngine q_engine3{qc3};
+    for (auto&& elem : qc3)
+        q_engine3.execute(elem);
+    EXPECT_NEAR(0, norm(q_engine3.get_psi() - ket::Ones(9) / 3.), 1e-7);
+
+    // duplicate target
+    EXPECT_THROW(qc.QFT({0, 0}), exception::Duplicates);
+}
+/******************************************************************************/
+/// BEGIN QEngineT& qpp::QEngineT::set_renormalization(idx period)
+TEST(qpp_QEngine_set_renormalization, AllTests) {
+    // single and double precision engines agree
+    QCircuit qc{4, 1};
+    qc.gate_fan(gt.H).CTRL(gt.X, 0, 1).gate(gt.RZ(0.3), 2).QFT({3, 1, 2});
+    qc.CTRL(gt.Z, {1, 2}, 3).gate(gt.T, 0);
+    QEngine q_engine{qc};
+    QEngine_f q_engine_f{qc};
+    for (auto&& elem : qc) {
+        q_engine.execute(elem);
+        q_engine_f.execute(elem);
+    }
+    EXPECT_NEAR(
+        0, norm(q_engine_f.get_psi().cast<cplx>() - q_engine.get_psi()),
+        1e-5);
+
+    // many gates, the norm is restored periodically
+    QCircuit qc_long{10, 0};
+    for (idx i = 0; i < 200; ++i)
+        qc_long.gate(gt.RY(0.1 * static_cast<double>(i)), i % 10)
+            .CTRL(gt.X, i % 10, (i + 3) % 10);
+    QEngine_f q_engine_long{qc_long};
+    q_engine_long.set_renormalization(50);
+    for (auto&& elem : qc_long)
+        q_engine_long.execute(elem);
+    EXPECT_NEAR(1, norm(q_engine_long.get_psi()), 1e-6);
+
+    // the noisy engine runs in single precision as well
+    QCircuit qc_flip{2, 2};
+    qc_flip.gate(gt.X, 0).measureZ(0, 0).measureZ(1, 1);
+    QNoisyEngine_f<QubitBitFlipNoise> q_engine_flip{qc_flip,
+                                                    QubitBitFlipNoise{1}};
+    std::map<std::vector<idx>, idx> hist = q_engine_flip.run(10);
+    EXPECT_EQ(10u, (hist[std::vector<idx>{0, 1}]));
+}
+/******************************************************************************/
+/// BEGIN std::map<std::vector<idx>, idx> qpp::QNoisyEngine::run(
+///       idx shots = 1)
+TEST(qpp_QNoisyEngine_run, AllTests) {
+    QCircuit qc{2, 2};
+    qc.gate(gt.X, 0).gate(gt.X, 1).gate(gt.H, 1).gate(gt.H, 1);
+    qc.measureZ(0, 0).measureZ(1, 1);
+
+    // noiseless gates, full amplitude damping of the idle qubits (note that
+    // gamma = 0 corresponds to full damping), qubit 0 decays while idle
+    QNoisyEngine<QubitDepolarizingNoise, QubitAmplitudeDampingNoise>
+        q_engine{qc, QubitDepolarizingNoise{0}, QubitAmplitudeDampingNoise{0}};
+    std::map<std::vector<idx>, idx> hist = q_engine.run(100);
+    EXPECT_EQ(1u, hist.size());
+    EXPECT_EQ(100u, (hist[std::vector<idx>{0, 1}]));
+
+    // certain bit flips on all qubits after each of the 4 gates
+    QNoisyEngine<QubitBitFlipNoise> q_engine_flip{qc, QubitBitFlipNoise{1}};
+    hist = q_engine_flip.run(100);
+    // the flip of qubit 1 between the H gates acts as a phase on |->
+    EXPECT_EQ(100u, (hist[std::vector<idx>{1, 0}]));
+    q_engine_flip.reset();
+    for (auto&& elem : qc)
+        q_engine_flip.execute(elem);
+    std::vector<std::vector<idx>> noise_results =
+        q_engine_flip.get_noise_results();
+    EXPECT_EQ(4u, noise_results.size());
+    for (auto&& elem : noise_results)
+        EXPECT_EQ((std::vector<idx>{1, 1}), elem);
+}
+/******************************************************************************/
@@ -128,6 +128,49 @@ TEST(qpp_Gates_CTRL, Qudits) {
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived>
+///       dyn_sparse_mat<typename Derived::Scalar> qpp::Gates::CTRL_sparse(
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& ctrl,
+///       const std::vector<idx>& target,
+///       idx n,
+///       idx d = 2) const
+TEST(qpp_Gates_CTRL_sparse, AllTests) {
+    // qubits, same as the dense gate
+    cmat U = randU(4);
+    sparse_cmat CTRL1 = gt.CTRL_sparse(U, {3, 0}, {4, 1}, 5);
+    EXPECT_NEAR(0, norm(cmat(CTRL1) - gt.CTRL(U, {3, 0}, {4, 1}, 5)), 1e-7);
+    // only the controlled block is dense
+    EXPECT_EQ(24 + 8 * 4, CTRL1.nonZeros());
+
+    // Toffoli
+    sparse_cmat TOF = gt.CTRL_sparse(gt.X, {0, 1}, {2}, 3);
+    EXPECT_EQ(8, TOF.nonZeros());
+    EXPECT_NEAR(0, norm(cmat(TOF) - gt.TOF), 1e-7);
+
+    // qutrits, all powers of the gate
+    cmat V = randU(3);
+    sparse_cmat CTRL3 = gt.CTRL_sparse(V, {2, 0}, {1}, 3, 3);
+    EXPECT_NEAR(0, norm(cmat(CTRL3) - gt.CTRL(V, {2, 0}, {1}, 3, 3)), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived>
+///       dyn_sparse_mat<typename Derived::Scalar>
+///       qpp::Gates::expandout_sparse(const Eigen::MatrixBase<Derived>& A,
+///       idx pos,
+///       const std::vector<idx>& dims) const
+TEST(qpp_Gates_expandout_sparse, AllTests) {
+    // qubit/qutrit/qubit system, random gate on the qutrit
+    cmat U = randU(3);
+    sparse_cmat result = gt.expandout_sparse(U, 1, {2, 3, 2});
+    EXPECT_NEAR(0, norm(cmat(result) - gt.expandout(U, 1, {2, 3, 2})), 1e-7);
+
+    // 3 qubits, X on qubit 2 expansion, a permutation matrix
+    result = gt.expandout_sparse(gt.X, 1, 3);
+    EXPECT_EQ(8, result.nonZeros());
+    EXPECT_NEAR(0, norm(cmat(result) - kron(gt.Id2, gt.X, gt.Id2)), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived>
 ///       dyn_mat<typename Derived::Scalar> qpp::Gates::expandout(
 ///       const Eigen::MatrixBase<Derived>& A,
 ///       idx pos,
@@ -206,7 +249,26 @@ TEST(qpp_Gates_Id, AllTests) {
 }
 /******************************************************************************/
 /// BEGIN cmat qpp::Gates::MODMUL(idx a, idx N) const
-TEST(qpp_Gates_MODMUL, AllTests) {}
+TEST(qpp_Gates_MODMUL, AllTests) {
+    // 4 x 7 mod 15 = 13, the states |x> with x >= N are left unchanged
+    cmat U = gt.MODMUL(7, 15, 4);
+    EXPECT_NEAR(0, norm(U * mket({0, 1, 0, 0}) - mket({1, 1, 0, 1})), 1e-7);
+    EXPECT_NEAR(0, norm(U * mket({1, 1, 1, 1}) - mket({1, 1, 1, 1})), 1e-7);
+    EXPECT_TRUE(U.isUnitary());
+}
+/******************************************************************************/
+/// BEGIN std::vector<idx> qpp::Gates::MODMUL_perm(idx a, idx N, idx n) const
+TEST(qpp_Gates_MODMUL_perm, AllTests) {
+    std::vector<idx> perm = gt.MODMUL_perm(7, 15, 5);
+    EXPECT_EQ(32u, perm.size());
+    EXPECT_EQ(13u, perm[4]);
+    EXPECT_EQ(20u, perm[20]);
+
+    // same as the matrix
+    cmat U = gt.MODMUL(7, 15, 5);
+    for (idx j = 0; j < perm.size(); ++j)
+        EXPECT_NEAR(1, std::abs(U(perm[j], j)), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN  cmat qpp::Gates::Rn(double theta, const std::vector<double>& n) const
 TEST(qpp_Gates_Rn, AllTests) {
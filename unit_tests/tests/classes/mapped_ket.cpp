@@ -0,0 +1,138 @@
+/*
+ * This file is part of Quantum++.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2013 - 2019 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/mapped_ket.h"
+
+#ifdef QPP_HAS_MMAP_
+
+/******************************************************************************/
+/// BEGIN qpp::MappedKetT::MappedKetT(const std::string& fname, idx D)
+///       qpp::MappedKetT::MappedKetT(const std::string& fname)
+TEST(qpp_MappedKet_MappedKet, AllTests) {
+    const std::string fname = "_mapped_ket.bin";
+
+    // create, write, re-open
+    ket psi = randket(16);
+    {
+        MappedKet mpsi{fname, 16};
+        EXPECT_EQ(16, mpsi.size());
+        EXPECT_NEAR(0, norm(mpsi), 1e-7);
+        mpsi = psi;
+        mpsi.sync();
+    }
+    {
+        MappedKet mpsi{fname};
+        EXPECT_EQ(16, mpsi.size());
+        EXPECT_EQ(16u, mpsi.get_capacity());
+        EXPECT_EQ(fname, mpsi.get_fname());
+        EXPECT_NEAR(0, norm(mpsi - psi), 1e-7);
+
+        // smaller states keep the capacity, larger ones grow the file
+        mpsi = psi.head(4);
+        EXPECT_EQ(4, mpsi.size());
+        EXPECT_EQ(16u, mpsi.get_capacity());
+        ket phi = randket(32);
+        mpsi = phi;
+        EXPECT_EQ(32u, mpsi.get_capacity());
+        EXPECT_NEAR(0, norm(mpsi - phi), 1e-7);
+    }
+    EXPECT_EQ(32, MappedKet{fname}.size());
+
+    // single precision file cannot be opened in double precision
+    { MappedKet_f mpsi_f{fname, 4}; }
+    EXPECT_THROW(MappedKet{fname}, std::runtime_error);
+
+    // corrupted size and capacity fields of the header
+    {
+        { MappedKet mpsi{fname, 4}; }
+        std::fstream fs{fname, std::ios::in | std::ios::out | std::ios::binary};
+        idx fields[2] = {idx{1} << 20, idx{1} << 60}; // size, capacity
+        fs.seekp(16 + sizeof(idx));
+        fs.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+    }
+    EXPECT_THROW(MappedKet{fname}, std::runtime_error);
+
+    // copies are anonymous mappings
+    MappedKet mpsi{fname, 8};
+    mpsi = psi.head(8);
+    MappedKet copy = mpsi;
+    EXPECT_EQ("", copy.get_fname());
+    copy(0) = 0;
+    EXPECT_NEAR(0, norm(mpsi - psi.head(8)), 1e-7);
+
+    EXPECT_THROW(MappedKet{""}, std::runtime_error);
+    EXPECT_THROW(MappedKet(fname, 0), exception::ZeroSize);
+    std::remove(fname.c_str());
+}
+/******************************************************************************/
+/// BEGIN qpp::QEngineT<qpp::MappedKet>
+TEST(qpp_MappedKet_QEngine, AllTests) {
+    const std::string fname = "_mapped_ket_engine.bin";
+
+    QCircuit qc{4, 2};
+    qc.gate_fan(gt.H).CTRL(gt.X, 0, 1).gate(gt.RZ(0.3), 2).QFT({3, 1, 2});
+    qc.CTRL(gt.Z, {1, 2}, 3).measureZ(0, 0).gate(gt.T, 1).measureZ(2, 1);
+
+    // the gates are applied on the mapping, the measurements shrink the state
+    MappedKet mpsi{fname, 16};
+    mpsi(0) = 1;
+    QEngineT<MappedKet> engine{qc, std::move(mpsi)};
+    QEngine reference{qc};
+    auto it = qc.begin();
+    for (idx i = 0; i < 5; ++i, ++it) {
+        engine.execute(it);
+        reference.execute(it);
+    }
+    EXPECT_NEAR(0, norm(engine.get_psi() - reference.get_psi()), 1e-7);
+
+    // checkpoint, then restart from the file
+    engine.get_ref_psi().sync();
+    QEngineT<MappedKet> restarted{qc, MappedKet{fname}};
+    EXPECT_NEAR(0, norm(restarted.get_psi() - reference.get_psi()), 1e-7);
+
+    // the dits are random, compare the probabilities only
+    for (; it != qc.end(); ++it)
+        engine.execute(it);
+    EXPECT_EQ(4, engine.get_psi().size());
+    EXPECT_NEAR(1, norm(engine.get_psi()), 1e-7);
+    // run() resets the state to its original size before each shot
+    EXPECT_LE(engine.run(10).size(), 4u);
+    EXPECT_EQ(16u, engine.get_ref_psi().get_capacity());
+    EXPECT_NEAR(1, norm(engine.get_psi()), 1e-7);
+
+    EXPECT_THROW((QEngineT<MappedKet>{qc, MappedKet{fname, 8}}),
+                 exception::DimsMismatchCvector);
+    std::remove(fname.c_str());
+}
+/******************************************************************************/
+
+#endif // QPP_HAS_MMAP_
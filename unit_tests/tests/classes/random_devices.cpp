@@ -25,6 +25,9 @@
  */
 
 #include <sstream>
+#ifdef WITH_OPENMP_
+#include <omp.h>
+#endif // WITH_OPENMP_
 #include "gtest/gtest.h"
 #include "qpp.h"
 
@@ -70,3 +73,57 @@ TEST(qpp_RandomDevices_load_save, AllTests) {
     EXPECT_EQ(d1, d2);
 }
 /******************************************************************************/
+/// BEGIN qpp::Philox4x32
+TEST(qpp_Philox4x32, AllTests) {
+    // known answers of the reference implementation (Random123)
+    std::uint32_t r[4];
+    Philox4x32{0}(0, r);
+    EXPECT_EQ(0x6627e8d5u, r[0]);
+    EXPECT_EQ(0xe169c58du, r[1]);
+    EXPECT_EQ(0xbc57ac4cu, r[2]);
+    EXPECT_EQ(0x9b00dbd8u, r[3]);
+    Philox4x32{~std::uint64_t{0}}(~std::uint64_t{0}, r, ~std::uint64_t{0});
+    EXPECT_EQ(0x408f276du, r[0]);
+    EXPECT_EQ(0x41c83b0eu, r[1]);
+    EXPECT_EQ(0xa20bc7c6u, r[2]);
+    EXPECT_EQ(0x6d5451fdu, r[3]);
+
+    // moments
+    std::vector<double> v(100000);
+    Philox4x32 philox{42};
+    philox.fill_normal(v.data(), v.size(), 1, 2);
+    double mean = std::accumulate(v.begin(), v.end(), 0.) / v.size();
+    double var = 0;
+    for (auto&& elem : v)
+        var += (elem - mean) * (elem - mean) / v.size();
+    EXPECT_NEAR(1, mean, 0.05); // very likely
+    EXPECT_NEAR(4, var, 0.1);   // very likely
+    philox.fill_uniform(v.data(), v.size(), -1, 1);
+    EXPECT_LT(*std::max_element(v.begin(), v.end()), 1);
+    EXPECT_GE(*std::min_element(v.begin(), v.end()), -1);
+}
+/******************************************************************************/
+/// BEGIN Philox4x32 qpp::RandomDevices::get_counter_based_prng()
+TEST(qpp_RandomDevices_get_counter_based_prng, AllTests) {
+    // the random matrices are determined by the seed of the Mersenne
+    // twister, whatever the number of threads
+    rdevs.get_prng().seed(12345);
+    ket psi1 = randket(1 << 16);
+    cmat A1 = rand<cmat>(300, 300);
+#ifdef WITH_OPENMP_
+    int nthreads = omp_get_max_threads();
+    omp_set_num_threads(nthreads == 1 ? 3 : 1);
+#endif // WITH_OPENMP_
+    rdevs.get_prng().seed(12345);
+    ket psi2 = randket(1 << 16);
+    cmat A2 = rand<cmat>(300, 300);
+#ifdef WITH_OPENMP_
+    omp_set_num_threads(nthreads);
+#endif // WITH_OPENMP_
+    EXPECT_EQ(0, norm(psi1 - psi2));
+    EXPECT_EQ(0, norm(A1 - A2));
+
+    // consecutive matrices differ
+    EXPECT_NE(0, norm(rand<cmat>(2, 2) - rand<cmat>(2, 2)));
+}
+/******************************************************************************/
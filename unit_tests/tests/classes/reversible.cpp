@@ -39,7 +39,19 @@ TEST(qpp_Dynamic_bitset_size, AllTests) {}
 TEST(qpp_Dynamic_bitset_storage_size, AllTests) {}
 /******************************************************************************/
 /// BEGIN idx qpp::Dynamic_bitset::count() const noexcept
-TEST(qpp_Dynamic_bitset_count, AllTests) {}
+TEST(qpp_Dynamic_bitset_count, AllTests) {
+    // several storage words, partially filled last word
+    Dynamic_bitset bs{70};
+    EXPECT_EQ(0u, bs.count());
+    bs.set(0).set(31).set(32).set(69);
+    EXPECT_EQ(4u, bs.count());
+
+    // the bits past the end of the bitset are not counted
+    bs.set();
+    EXPECT_EQ(70u, bs.count());
+    bs.flip();
+    EXPECT_EQ(0u, bs.count());
+}
 /******************************************************************************/
 /// BEGIN bool qpp::Dynamic_bitset::get(idx pos) const noexcept
 TEST(qpp_Dynamic_bitset_get, AllTests) {}
@@ -87,7 +99,15 @@ TEST(qpp_Dynamic_bitset_operator_noneq, AllTests) {}
 /******************************************************************************/
 /// BEGIN idx qpp::Dynamic_bitset::operator-(const Dynamic_bitset& rhs)
 ///        const noexcept
-TEST(qpp_Dynamic_bitset_operator_minus, AllTests) {}
+TEST(qpp_Dynamic_bitset_operator_minus, AllTests) {
+    Dynamic_bitset bs1{70}, bs2{70};
+    EXPECT_EQ(0u, bs1 - bs2);
+    bs1.set(3).set(40).set(69);
+    bs2.set(3).set(41);
+    EXPECT_EQ(3u, bs1 - bs2);
+    bs1.set();
+    EXPECT_EQ(68u, bs1 - bs2);
+}
 /******************************************************************************/
 /// BEGIN template <class CharT = char, class Traits = std::char_traits<CharT>,
 ///        class Allocator = std::allocator<CharT>>
@@ -102,17 +122,150 @@ TEST(qpp_Bit_circuit_X, AllTests) {}
 TEST(qpp_Bit_circuit_NOT, AllTests) {}
 /******************************************************************************/
 /// BEGIN Bit_circuit& qpp::Bit_circuit::CNOT(const std::vector<idx>& pos)
-TEST(qpp_Bit_circuit_CNOT, AllTests) {}
+///
+///       Bit_circuit& qpp::Bit_circuit::CNOT(idx ctrl, idx target)
+TEST(qpp_Bit_circuit_CNOT, AllTests) {
+    Bit_circuit bc{40};
+    bc.CNOT(0, 35);
+    EXPECT_FALSE(bc.get(35));
+    bc.X(0).CNOT(0, 35);
+    EXPECT_TRUE(bc.get(35));
+    bc.CNOT({0, 35});
+    EXPECT_FALSE(bc.get(35));
+    EXPECT_EQ(3u, bc.gate_count.CNOT);
+}
 /******************************************************************************/
 /// BEGIN Bit_circuit& qpp::Bit_circuit::TOF(const std::vector<idx>& pos)
-TEST(qpp_Bit_circuit_TOF, AllTests) {}
+///
+///       Bit_circuit& qpp::Bit_circuit::TOF(idx ctrl1, idx ctrl2, idx target)
+TEST(qpp_Bit_circuit_TOF, AllTests) {
+    for (idx i = 0; i < 8; ++i) {
+        Bit_circuit bc{3};
+        bc.set(0, i & 1).set(1, i & 2).set(2, i & 4);
+        bc.TOF(0, 1, 2);
+        EXPECT_EQ(static_cast<bool>(i & 4) != ((i & 3) == 3), bc.get(2));
+        bc.TOF({0, 1, 2});
+        EXPECT_EQ(static_cast<bool>(i & 4), bc.get(2));
+    }
+}
 /******************************************************************************/
 /// BEGIN Bit_circuit& qpp::Bit_circuit::SWAP(const std::vector<idx>& pos)
-TEST(qpp_Bit_circuit_SWAP, AllTests) {}
+///
+///       Bit_circuit& qpp::Bit_circuit::SWAP(idx pos1, idx pos2)
+TEST(qpp_Bit_circuit_SWAP, AllTests) {
+    Bit_circuit bc{3};
+    bc.X(0).SWAP(0, 2);
+    EXPECT_EQ("100", bc.to_string());
+    bc.SWAP({2, 1});
+    EXPECT_EQ("010", bc.to_string());
+    EXPECT_EQ(2u, bc.gate_count.SWAP);
+    EXPECT_EQ(1u, bc.gate_count.X);
+}
 /******************************************************************************/
 /// BEGIN Bit_circuit& qpp::Bit_circuit::FRED(const std::vector<idx>& pos)
-TEST(qpp_Bit_circuit_FRED, AllTests) {}
+///
+///       Bit_circuit& qpp::Bit_circuit::FRED(idx ctrl, idx target1,
+///       idx target2)
+TEST(qpp_Bit_circuit_FRED, AllTests) {
+    Bit_circuit bc{3};
+    bc.X(1).FRED(0, 1, 2);
+    EXPECT_EQ("010", bc.to_string());
+    bc.X(0).FRED({0, 1, 2});
+    EXPECT_EQ("101", bc.to_string());
+}
 /******************************************************************************/
 /// BEGIN Bit_circuit& qpp::Bit_circuit::reset() noexcept
 TEST(qpp_Bit_circuit_reset, AllTests) {}
 /******************************************************************************/
+/// BEGIN qpp::Sliced_bit_circuit
+TEST(qpp_Sliced_bit_circuit, AllTests) {
+    // exhaustive check of a 3-bit adder, b += a, with a ripple carry
+    // a on bits 0..2, b on bits 3..5, carries on 6..7, carry out on 8
+    auto adder = [](Sliced_bit_circuit<4>& bc) {
+        bc.TOF(0, 3, 6).CNOT(0, 3);
+        bc.TOF(1, 4, 7).CNOT(1, 4).TOF(6, 4, 7).CNOT(6, 4);
+        bc.TOF(2, 5, 8).CNOT(2, 5).TOF(7, 5, 8).CNOT(7, 5);
+    };
+    Sliced_bit_circuit<4> bc{9};
+    EXPECT_EQ(256u, bc.batch_size());
+    for (idx first = 0; first < 64; first += bc.batch_size()) {
+        bc.reset().set_range(first, 0, 6);
+        adder(bc);
+        for (idx j = 0; first + j < 64; ++j) {
+            idx a = (first + j) & 7, b = (first + j) >> 3;
+            EXPECT_EQ(a, bc.get_value(j, 0, 3));
+            EXPECT_EQ(a + b, bc.get_value(j, 3, 3) + 8 * bc.get(8, j));
+        }
+    }
+
+    // agrees with qpp::Bit_circuit on random inputs
+    Sliced_bit_circuit<1> sbc{70};
+    std::vector<Bit_circuit> bcs;
+    for (idx j = 0; j < sbc.batch_size(); ++j) {
+        Bit_circuit bit_circuit{70};
+        bit_circuit.rand();
+        sbc.set_input(j, bit_circuit);
+        bcs.emplace_back(bit_circuit);
+    }
+    sbc.X(69).CNOT(0, 65).TOF(3, 66, 1).SWAP(2, 68).FRED(1, 5, 67);
+    for (auto&& elem : bcs)
+        elem.X(69).CNOT(0, 65).TOF(3, 66, 1).SWAP(2, 68).FRED(1, 5, 67);
+    for (idx j = 0; j < sbc.batch_size(); ++j)
+        EXPECT_EQ(bcs[j].to_string(), sbc.get_input(j).to_string());
+}
+/******************************************************************************/
+/// BEGIN qpp::Compiled_bit_circuit
+TEST(qpp_Compiled_bit_circuit, AllTests) {
+    // replay on qpp::Bit_circuit, inverse
+    Compiled_bit_circuit cbc{5};
+    cbc.X(0).CNOT(0, 1).TOF(0, 1, 2).SWAP(2, 3).FRED(3, 0, 4);
+    EXPECT_EQ(5u, cbc.get_gate_count());
+    EXPECT_EQ(5u, cbc.get_depth());
+    Bit_circuit bc{5};
+    Bit_circuit expected{5};
+    expected.X(0).CNOT(0, 1).TOF(0, 1, 2).SWAP(2, 3).FRED(3, 0, 4);
+    EXPECT_EQ(expected.to_string(), cbc.apply(bc).to_string());
+    EXPECT_EQ(1u, bc.gate_count.TOF);
+    EXPECT_EQ("00000", cbc.inverse().apply(bc).to_string());
+
+    // depth, gates on disjoint bits share a layer
+    Compiled_bit_circuit layers{4};
+    layers.X(0).X(1).CNOT(2, 3).TOF(0, 1, 2).X(3);
+    EXPECT_EQ(2u, layers.get_depth());
+
+    // cancellation of adjacent pairs, also through gates on other bits; the
+    // SWAPs are separated by a CNOT on bit 0, hence kept
+    Compiled_bit_circuit pairs{4};
+    pairs.TOF(0, 1, 2).X(3).CNOT(2, 3).CNOT(2, 3).TOF(1, 0, 2).SWAP(0, 1);
+    pairs.CNOT(0, 3).SWAP(1, 0);
+    pairs.cancel_pairs();
+    EXPECT_EQ(4u, pairs.get_gate_count());
+    EXPECT_EQ(Compiled_bit_circuit::Gate_type::NOT,
+              pairs.get_gates()[0].type);
+
+    // dead gates, only bit 3 is an output
+    Compiled_bit_circuit dead{5};
+    dead.X(4).CNOT(0, 1).CNOT(1, 3).TOF(0, 3, 2).SWAP(2, 4).X(2);
+    dead.remove_dead_gates({3});
+    EXPECT_EQ(2u, dead.get_gate_count());
+    dead.remove_dead_gates({});
+    EXPECT_EQ(0u, dead.get_gate_count());
+    EXPECT_THROW(dead.X(5), exception::OutOfRange);
+
+    // many inputs, agrees with qpp::Bit_circuit
+    Compiled_bit_circuit adder{9};
+    adder.TOF(0, 3, 6).CNOT(0, 3);
+    adder.TOF(1, 4, 7).CNOT(1, 4).TOF(6, 4, 7).CNOT(6, 4);
+    adder.TOF(2, 5, 8).CNOT(2, 5).TOF(7, 5, 8).CNOT(7, 5);
+    std::vector<Dynamic_bitset> inputs;
+    for (idx i = 0; i < 1000; ++i)
+        inputs.emplace_back(Dynamic_bitset{9}.rand());
+    std::vector<Dynamic_bitset> outputs = adder.run(inputs);
+    ASSERT_EQ(1000u, outputs.size());
+    for (idx i = 0; i < 1000; ++i) {
+        Bit_circuit reference{inputs[i]};
+        EXPECT_EQ(adder.apply(reference).to_string(), outputs[i].to_string());
+    }
+    EXPECT_THROW(adder.run({Dynamic_bitset{8}}), exception::SizeMismatch);
+}
+/******************************************************************************/
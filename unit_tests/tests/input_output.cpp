@@ -147,4 +147,69 @@ TEST(qpp_load_save, Vectors) {
     ket load_expression = qpp::load<ket>("out.tmp");
     EXPECT_NEAR(0, norm(load_expression - expression), 1e-7);
 }
+
+TEST(qpp_load_save, ChunkedFormat) {
+    // several chunks, the last one shorter
+    ket psi = randket(1000);
+    qpp::save(psi, "out.tmp", 64);
+    EXPECT_NEAR(0, norm(qpp::load<ket>("out.tmp") - psi), 1e-7);
+    qpp::save(psi, "out.tmp", 4096); // one chunk
+    EXPECT_NEAR(0, norm(qpp::load<ket>("out.tmp") - psi), 1e-7);
+
+    // the scalar type is recorded
+    EXPECT_THROW(qpp::load<dmat>("out.tmp"), exception::TypeMismatch);
+    EXPECT_THROW(qpp::load<ket_f>("out.tmp"), exception::TypeMismatch);
+
+    // corrupted element
+    qpp::save(psi, "out.tmp", 64);
+    {
+        std::fstream f{"out.tmp",
+                       std::ios::in | std::ios::out | std::ios::binary};
+        f.seekp(-3, std::ios::end);
+        f.put('x');
+    }
+    EXPECT_THROW(qpp::load<ket>("out.tmp"), std::runtime_error);
+
+    // format without chunks, written by earlier versions
+    dmat A = rand<dmat>(3, 4);
+    {
+        std::fstream f{"out.tmp", std::ios::out | std::ios::binary};
+        const std::string header = "TYPE::Eigen::Matrix";
+        idx rows = 3, cols = 4;
+        f.write(header.c_str(), header.length());
+        f.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+        f.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+        f.write(reinterpret_cast<const char*>(A.data()), sizeof(double) * 12);
+    }
+    EXPECT_NEAR(0, norm(qpp::load<dmat>("out.tmp") - A), 1e-7);
+}
+/******************************************************************************/
+
+/******************************************************************************/
+/// BEGIN template<typename Derived> dyn_col_vect<typename Derived::Scalar>
+///       qpp::load_slice(const std::string& fname, idx first, idx count)
+TEST(qpp_load_slice, AllTests) {
+    ket psi = randket(1000);
+    qpp::save(psi, "out.tmp", 64);
+
+    // within one chunk, across chunks, everything
+    EXPECT_NEAR(
+        0, norm(load_slice<ket>("out.tmp", 70, 10) - psi.segment(70, 10)),
+        1e-7);
+    EXPECT_NEAR(
+        0, norm(load_slice<ket>("out.tmp", 50, 300) - psi.segment(50, 300)),
+        1e-7);
+    EXPECT_NEAR(0, norm(load_slice<ket>("out.tmp", 0, 1000) - psi), 1e-7);
+    EXPECT_NEAR(0, norm(load_slice<ket>("out.tmp", 999, 1) - psi.tail(1)),
+                1e-7);
+
+    // matrices, in column-major order
+    cmat A = rand<cmat>(8, 8);
+    qpp::save(A, "out.tmp", 5);
+    EXPECT_NEAR(0, norm(load_slice<cmat>("out.tmp", 16, 8) - A.col(2)), 1e-7);
+
+    EXPECT_THROW(load_slice<cmat>("out.tmp", 60, 5), exception::OutOfRange);
+    EXPECT_THROW(load_slice<cmat>("out.tmp", 0, 0), exception::ZeroSize);
+    std::remove("out.tmp");
+}
 /******************************************************************************/
@@ -37,7 +37,30 @@ using namespace qpp;
 ///       const Eigen::MatrixBase<Derived>& psi,
 ///       const std::vector<idx>& subsys,
 ///       const std::vector<idx>& dims)
-TEST(qpp_ip, AllTests) {}
+TEST(qpp_ip, AllTests) {
+    // product state, <phi|b> |a>|c>
+    ket a = randket(2), b = randket(3), c = randket(2);
+    ket phi = randket(3);
+    ket psi = kron(a, b, c);
+    EXPECT_NEAR(0,
+                norm(ip(phi, psi, {1}, {2, 3, 2}) -
+                     (adjoint(phi) * b).value() * kron(a, c)),
+                1e-7);
+
+    // phi over the first and last subsystems, in reverse order
+    ket chi = randket(4);
+    ket result = ip(chi, psi, {2, 0}, {2, 3, 2});
+    EXPECT_NEAR(0,
+                norm(result - (adjoint(chi) * kron(c, a)).value() * b),
+                1e-7);
+
+    // phi over all subsystems, the usual inner product
+    ket xi = randket(12);
+    EXPECT_NEAR(0,
+                std::abs(ip(xi, psi, {0, 1, 2}, {2, 3, 2})(0) -
+                         (adjoint(xi) * psi).value()),
+                1e-7);
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_col_vect<typename Derived::Scalar>
 ///       qpp::ip(const Eigen::MatrixBase<Derived>& phi,
@@ -122,5 +145,42 @@ TEST(qpp_measure_seq_qubits, AllTests) {}
 ///       qpp::measure_seq(const Eigen::MatrixBase<Derived>& A,
 ///       std::vector<idx> target,
 ///       std::vector<idx> dims)
-TEST(qpp_measure_seq, AllTests) {}
+TEST(qpp_measure_seq, AllTests) {
+    // (|010> + |121>) / sqrt(2), mixed qubit/qutrit dimensions
+    std::vector<idx> dims{2, 3, 2};
+    ket psi = (mket({0, 1, 0}, dims) + mket({1, 2, 1}, dims)) / std::sqrt(2);
+
+    // ket
+    std::vector<idx> results;
+    double prob;
+    cmat post;
+    std::tie(results, prob, post) = measure_seq(psi, {2, 0}, dims);
+    EXPECT_EQ(2u, results.size());
+    EXPECT_EQ(results[0], results[1]);
+    EXPECT_NEAR(0.5, prob, 1e-7);
+    ket expected = mket({results[0] + 1}, {3});
+    EXPECT_NEAR(1, std::abs((adjoint(expected) * post).value()), 1e-7);
+
+    // density matrix
+    std::tie(results, prob, post) = measure_seq(prj(psi), {0, 2}, dims);
+    EXPECT_EQ(results[0], results[1]);
+    EXPECT_NEAR(0.5, prob, 1e-7);
+    expected = mket({results[0] + 1}, {3});
+    EXPECT_NEAR(0, norm(post - prj(expected)), 1e-7);
+
+    // all subsystems measured
+    std::tie(results, prob, post) = measure_seq(psi, {0, 1, 2}, dims);
+    EXPECT_EQ(1, post.size());
+    EXPECT_NEAR(0.5, prob, 1e-7);
+
+    // single precision, the post-measurement state stays in single precision
+    ket_f psi_f = psi.cast<cplx_f>();
+    cmat_f post_f;
+    std::tie(results, prob, post_f) = measure_seq(psi_f, {2, 0}, dims);
+    EXPECT_EQ(results[0], results[1]);
+    EXPECT_NEAR(0.5, prob, 1e-5);
+    expected = mket({results[0] + 1}, {3});
+    EXPECT_NEAR(
+        1, std::abs((adjoint(expected) * post_f.cast<cplx>()).value()), 1e-5);
+}
 /******************************************************************************/
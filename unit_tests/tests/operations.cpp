@@ -95,16 +95,75 @@ TEST(qpp_apply, AllTests) {
 ///       idx d = 2)
 TEST(qpp_apply_qubits, AllTests) {}
 /******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2>
+///       dyn_mat<typename Derived1::Scalar> qpp::apply(
+///       const Eigen::MatrixBase<Derived1>& state,
+///       const Eigen::SparseMatrixBase<Derived2>& A,
+///       const std::vector<idx>& target,
+///       const std::vector<idx>& dims)
+TEST(qpp_apply_sparse, AllTests) {
+    // qubit/qutrit/qubit state vector, sparse gate on part of the system
+    std::vector<idx> dims{2, 3, 2};
+    ket psi = randket(12);
+    cmat U = kron(gt.Id2, gt.Xd(3));
+    sparse_cmat spU = U.sparseView();
+    EXPECT_NEAR(0, norm(apply(psi, spU, {2, 1}, dims) -
+                        apply(psi, U, {2, 1}, dims)),
+                1e-7);
+
+    // sparse gate acting on the whole system
+    sparse_cmat CTRL = gt.CTRL_sparse(randU(4), {0}, {3, 1}, 4);
+    ket phi = randket(16);
+    EXPECT_NEAR(0, norm(apply(phi, CTRL, {0, 1, 2, 3}) - CTRL * phi), 1e-7);
+
+    // density matrix
+    cmat rho = randrho(12);
+    EXPECT_NEAR(0, norm(apply(rho, spU, {2, 1}, dims) -
+                        apply(rho, U, {2, 1}, dims)),
+                1e-7);
+
+    // the gate does not match the target
+    EXPECT_THROW(apply(psi, spU, {1}, dims), exception::MatrixMismatchSubsys);
+}
+/******************************************************************************/
 /// BEGIN template<typename Derived> cmat qpp::apply(
 ///       const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks)
-TEST(qpp_apply_full_kraus, AllTests) {}
+TEST(qpp_apply_full_kraus, AllTests) {
+    idx D = 6;
+    cmat rho = randrho(D);
+    std::vector<cmat> Ks = randkraus(5, D);
+
+    cmat expected = cmat::Zero(D, D);
+    for (auto&& elem : Ks)
+        expected += elem * rho * adjoint(elem);
+
+    EXPECT_NEAR(0, norm(apply(rho, Ks) - expected), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived> cmat qpp::apply(
 ///       const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<cmat>& Ks,
 ///       const std::vector<idx>& target,
 ///       const std::vector<idx>& dims)
-TEST(qpp_apply_kraus, AllTests) {}
+TEST(qpp_apply_kraus, AllTests) {
+    std::vector<idx> dims{3, 2, 3}; // mixed qubit/qutrit dimensions
+    idx D = prod(dims);             // total dimension
+    std::vector<idx> target{2, 1};
+    cmat rho = randrho(D);
+
+    // few Kraus operators (two strided passes each) and many Kraus
+    // operators (one pass of the superoperator)
+    for (idx N : {1, 2, 8}) {
+        std::vector<cmat> Ks = randkraus(N, 6);
+        cmat expected = cmat::Zero(D, D);
+        for (auto&& elem : Ks)
+            expected += apply(rho, elem, target, dims);
+
+        cmat result = apply(rho, Ks, target, dims);
+        EXPECT_NEAR(0, norm(result - expected), 1e-7);
+        EXPECT_NEAR(1, std::real(trace(result)), 1e-7);
+    }
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived> cmat qpp::apply(
 ///       const Eigen::MatrixBase<Derived>& A,
@@ -183,6 +242,27 @@ TEST(qpp_applyCTRL, EmptyControl) {
     double res = norm(result_psi - result_rho);
     EXPECT_NEAR(0, res, 1e-7);
 }
+
+TEST(qpp_applyCTRL, DensityMatrixQudits) {
+    std::vector<idx> dims{3, 2, 3, 3}; // mixed qubit/qutrit dimensions
+    idx D = prod(dims);                // total dimension
+
+    std::vector<idx> ctrl{3, 0};   // where we apply the control
+    std::vector<idx> target{1, 2}; // target
+
+    // some random mixed state, as a mixture of two pure states
+    ket psi1 = randket(D);
+    ket psi2 = randket(D);
+    cmat rho = 0.3 * prj(psi1) + 0.7 * prj(psi2);
+    cmat U = randU(6); // some random unitary on the target
+
+    cmat result = applyCTRL(rho, U, ctrl, target, dims);
+    ket A1 = applyCTRL(psi1, U, ctrl, target, dims);
+    ket A2 = applyCTRL(psi2, U, ctrl, target, dims);
+    cmat expected = 0.3 * prj(A1) + 0.7 * prj(A2);
+
+    EXPECT_NEAR(0, norm(result - expected), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived1, typename Derived2>
 ///       dyn_mat<typename Derived1::Scalar> qpp::applyCTRL(
@@ -191,21 +271,186 @@ TEST(qpp_applyCTRL, EmptyControl) {
 ///       const std::vector<idx>& ctrl,
 ///       const std::vector<idx>& target,
 ///       idx d = 2)
-TEST(qpp_applyCTRL_qubits, AllTests) {}
+TEST(qpp_applyCTRL_qubits, AllTests) {
+    // 1 and 2 target qubit gates, with and without controls, compared with
+    // the full matrix of the controlled gate
+    idx n = 5;
+    ket psi = randket(prod(std::vector<idx>(n, 2)));
+
+    // single target, controls below and above the target
+    cmat U = randU(2);
+    ket result = applyCTRL(psi, U, {4, 0}, {2});
+    ket expected = gt.CTRL(U, {4, 0}, {2}, n) * psi;
+    EXPECT_NEAR(0, norm(result - expected), 1e-7);
+
+    // two targets in decreasing order
+    U = randU(4);
+    result = applyCTRL(psi, U, {1}, {4, 0});
+    expected = gt.CTRL(U, {1}, {4, 0}, n) * psi;
+    EXPECT_NEAR(0, norm(result - expected), 1e-7);
+
+    // no control
+    result = applyCTRL(psi, U, {}, {3, 1});
+    EXPECT_NEAR(0, norm(prj(result) - applyCTRL(prj(psi), U, {}, {3, 1})),
+                1e-7);
+}
+TEST(qpp_applyCTRL, DiagonalGates) {
+    std::vector<idx> dims{3, 3, 3, 3}; // qutrits
+    idx D = prod(dims);                // total dimension
+    ket psi = randket(D);
+    cmat rho = randrho(D);
+
+    // diagonal gates are applied as one elementwise multiplication
+    cmat U = cmat::Zero(9, 9);
+    U.diagonal() = randket(9);
+    EXPECT_NEAR(0,
+                norm(applyCTRL(psi, U, {2}, {3, 0}, dims) -
+                     gt.CTRL(U, {2}, {3, 0}, 4, 3) * psi),
+                1e-7);
+    // tiny off-diagonal entries force the dense kernel
+    EXPECT_NEAR(0,
+                norm(applyCTRL(rho, U, {1, 2}, {0, 3}, dims) -
+                     applyCTRL(rho, cmat(U + 1e-20 * randU(9)), {1, 2},
+                               {0, 3}, dims)),
+                1e-7);
+
+    // qubits
+    psi = randket(16);
+    EXPECT_NEAR(0,
+                norm(applyCTRL(psi, gt.T, {0, 3}, {1}) -
+                     gt.CTRL(gt.T, {0, 3}, {1}, 4) * psi),
+                1e-7);
+    EXPECT_NEAR(0,
+                norm(apply(psi, gt.CZ, {2, 0}) -
+                     gt.CTRL(gt.Z, {2}, {0}, 4) * psi),
+                1e-7);
+}
+TEST(qpp_applyCTRL, SinglePrecision) {
+    std::vector<idx> dims{2, 3, 2, 3}; // mixed qubit/qutrit dimensions
+    ket psi = randket(36);
+    ket_f psi_f = psi.cast<cplx_f>();
+    cmat U = randU(6);
+
+    // double precision gates are converted to the precision of the state
+    ket_f result_f = applyCTRL(psi_f, U, {}, {3, 0}, dims);
+    ket result = applyCTRL(psi, U, {}, {3, 0}, dims);
+    EXPECT_NEAR(0, norm(result_f.cast<cplx>() - result), 1e-5);
+    result_f = apply(psi_f, U, {1, 2}, dims);
+    result = apply(psi, U, {1, 2}, dims);
+    EXPECT_NEAR(0, norm(result_f.cast<cplx>() - result), 1e-5);
+
+    // density matrix
+    cmat rho = randrho(12);
+    cmat_f rho_f = rho.cast<cplx_f>();
+    cmat_f out_f = applyCTRL(rho_f, gt.X, {0}, {2}, {2, 3, 2});
+    EXPECT_NEAR(0,
+                norm(out_f.cast<cplx>() -
+                     applyCTRL(rho, gt.X, {0}, {2}, {2, 3, 2})),
+                1e-5);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived>
+///       dyn_mat<typename Derived::Scalar> qpp::applyCTRL(
+///       const Eigen::MatrixBase<Derived>& state,
+///       const std::vector<idx>& perm,
+///       const std::vector<idx>& ctrl,
+///       const std::vector<idx>& target,
+///       const std::vector<idx>& dims)
+TEST(qpp_applyCTRL_perm, AllTests) {
+    std::vector<idx> dims{3, 2, 3, 2}; // mixed qubit/qutrit dimensions
+    idx D = prod(dims);                // total dimension
+
+    std::vector<idx> ctrl{2};
+    std::vector<idx> target{3, 0};
+
+    // random permutation of the basis states of the target, as a matrix
+    std::vector<idx> perm(6);
+    std::iota(std::begin(perm), std::end(perm), 0);
+    std::shuffle(std::begin(perm), std::end(perm),
+                 RandomDevices::get_instance().get_prng());
+    cmat P = cmat::Zero(6, 6);
+    for (idx j = 0; j < 6; ++j)
+        P(perm[j], j) = 1;
+
+    ket psi = randket(D);
+    EXPECT_NEAR(0,
+                norm(applyCTRL(psi, perm, ctrl, target, dims) -
+                     applyCTRL(psi, P, ctrl, target, dims)),
+                1e-7);
+    EXPECT_NEAR(0,
+                norm(apply(psi, perm, target, dims) -
+                     apply(psi, P, target, dims)),
+                1e-7);
+
+    cmat rho = randrho(D);
+    EXPECT_NEAR(0,
+                norm(applyCTRL(rho, perm, ctrl, target, dims) -
+                     applyCTRL(rho, P, ctrl, target, dims)),
+                1e-7);
+
+    // qubits, controlled modular multiplication
+    perm = gt.MODMUL_perm(7, 15, 4);
+    psi = randket(32);
+    EXPECT_NEAR(0,
+                norm(applyCTRL(psi, perm, {0}, {1, 2, 3, 4}) -
+                     applyCTRL(psi, gt.MODMUL(7, 15, 4), {0}, {1, 2, 3, 4})),
+                1e-7);
+}
 /******************************************************************************/
 /// BEGIN  template<typename Derived> dyn_mat<typename Derived::Scalar>
 ///        qpp::applyTFQ(const Eigen::MatrixBase<Derived>& A,
 ///        const std::vector<idx>& target,
 ///        idx d = 2,
 ///        bool swap = true)
-TEST(qpp_applyTQF, AllTests) {}
+TEST(qpp_applyTQF, AllTests) {
+    // qubits, TFQ undoes QFT, with and without the swaps
+    ket psi = randket(32);
+    for (bool swap : {true, false}) {
+        ket result = applyTFQ(applyQFT(psi, {3, 0, 4}, 2, swap), {3, 0, 4},
+                              2, swap);
+        EXPECT_NEAR(0, norm(result - psi), 1e-7);
+    }
+    // same as the adjoint of the Fourier matrix
+    ket result = applyTFQ(psi, {1, 4, 2});
+    EXPECT_NEAR(0, norm(result - apply(psi, adjoint(gt.Fd(8)), {1, 4, 2})),
+                1e-7);
+
+    // qutrits, density matrix
+    cmat rho = randrho(27);
+    cmat F = gt.Fd(9);
+    cmat rho_result = applyTFQ(rho, {2, 0}, 3);
+    EXPECT_NEAR(0, norm(rho_result - apply(rho, adjoint(F), {2, 0}, 3)),
+                1e-7);
+}
 /******************************************************************************/
 /// BEGIN  template<typename Derived> dyn_mat<typename Derived::Scalar>
 ///        qpp::applyQFT(const Eigen::MatrixBase<Derived>& A,
 ///        const std::vector<idx>& target,
 ///        idx d = 2,
 ///        bool swap = true)
-TEST(qpp_applyQFT, AllTests) {}
+TEST(qpp_applyQFT, AllTests) {
+    // qubits, the QFT on k qubits is the 2^k x 2^k Fourier matrix
+    ket psi = randket(32);
+    ket result = applyQFT(psi, {1, 4, 2});
+    EXPECT_NEAR(0, norm(result - apply(psi, gt.Fd(8), {1, 4, 2})), 1e-7);
+    // without the swaps the target qubits end up in reversed order
+    result = applyQFT(psi, {1, 4, 2}, 2, false);
+    result = apply(result, gt.SWAP, {1, 2});
+    EXPECT_NEAR(0, norm(result - apply(psi, gt.Fd(8), {1, 4, 2})), 1e-7);
+    // all qubits
+    EXPECT_NEAR(0, norm(applyQFT(psi, {0, 1, 2, 3, 4}) - gt.Fd(32) * psi),
+                1e-7);
+
+    // qutrits
+    ket psi3 = randket(81);
+    result = applyQFT(psi3, {3, 1}, 3);
+    EXPECT_NEAR(0, norm(result - apply(psi3, gt.Fd(9), {3, 1}, 3)), 1e-7);
+
+    // qubits, density matrix
+    cmat rho = randrho(16);
+    cmat rho_result = applyQFT(rho, {2, 0, 3});
+    EXPECT_NEAR(0, norm(rho_result - apply(rho, gt.Fd(8), {2, 0, 3})), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN inline std::vector<cmat> qpp::choi2kraus(const cmat& A)
 TEST(qpp_choi2kraus, AllTests) {}
@@ -229,7 +474,36 @@ TEST(qpp_kraus2super, AllTests) {}
 ///       qpp::ptrace(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target,
 ///       const std::vector<idx>& dims)
-TEST(qpp_ptrace, AllTests) {}
+TEST(qpp_ptrace, AllTests) {
+    // state vector, same as the partial trace of the projector, for the
+    // leading, trailing and scattered kept subsystems
+    std::vector<idx> dims{2, 3, 2, 2, 3};
+    ket psi = randket(72);
+    cmat rho = prj(psi);
+    for (auto&& target : std::vector<std::vector<idx>>{
+             {0}, {4}, {1, 3}, {3, 4}, {0, 1, 2}, {2, 0, 4}}) {
+        EXPECT_NEAR(0,
+                    norm(ptrace(psi, target, dims) - ptrace(rho, target, dims)),
+                    1e-7);
+    }
+
+    // qubits, more target blocks than one chunk of the kernel
+    ket phi = randket(1024);
+    std::vector<idx> target{0, 2, 3, 4, 5, 6, 7, 9};
+    cmat result = ptrace(phi, target);
+    EXPECT_NEAR(0, norm(result - ptrace(cmat(prj(phi)), target)), 1e-7);
+    EXPECT_NEAR(1, std::real(trace(result)), 1e-7);
+
+    // density matrix, product operator
+    cmat A = rand<cmat>(2, 2), B = rand<cmat>(3, 3), C = rand<cmat>(2, 2);
+    cmat ABC = kron(A, B, C);
+    EXPECT_NEAR(0,
+                norm(ptrace(ABC, {1}, {2, 3, 2}) - trace(B) * kron(A, C)),
+                1e-7);
+    EXPECT_NEAR(0,
+                norm(ptrace(ABC, {2, 0}, {2, 3, 2}) - trace(A) * trace(C) * B),
+                1e-7);
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::ptrace(const Eigen::MatrixBase<Derived>& A,
@@ -259,7 +533,32 @@ TEST(qpp_ptrace2_qubits, AllTests) {}
 ///       qpp::ptranspose(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& target,
 ///       const std::vector<idx>& dims)
-TEST(qpp_ptranspose, AllTests) {}
+TEST(qpp_ptranspose, AllTests) {
+    // density matrix, product operator
+    std::vector<idx> dims{2, 3, 2};
+    cmat A = rand<cmat>(2, 2), B = rand<cmat>(3, 3), C = rand<cmat>(2, 2);
+    cmat ABC = kron(A, B, C);
+    EXPECT_NEAR(
+        0, norm(ptranspose(ABC, {1}, dims) - kron(A, transpose(B), C)), 1e-7);
+    EXPECT_NEAR(0,
+                norm(ptranspose(ABC, {2, 0}, dims) -
+                     kron(transpose(A), B, transpose(C))),
+                1e-7);
+    EXPECT_NEAR(0, norm(ptranspose(ABC, {0, 1, 2}, dims) - transpose(ABC)),
+                1e-7);
+
+    // state vector, same as the partial transpose of the projector
+    std::vector<idx> dims_psi{2, 3, 2, 2};
+    ket psi = randket(24);
+    cmat rho = prj(psi);
+    for (auto&& target :
+         std::vector<std::vector<idx>>{{0}, {3}, {1, 2}, {3, 0}}) {
+        EXPECT_NEAR(0,
+                    norm(ptranspose(psi, target, dims_psi) -
+                         ptranspose(rho, target, dims_psi)),
+                    1e-7);
+    }
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::ptranspose(const Eigen::MatrixBase<Derived>& A,
@@ -280,7 +579,37 @@ TEST(qpp_super2choi, AllTests) {}
 ///       qpp::syspermute(const Eigen::MatrixBase<Derived>& A,
 ///       const std::vector<idx>& perm,
 ///       const std::vector<idx>& dims)
-TEST(qpp_syspermute, AllTests) {}
+TEST(qpp_syspermute, AllTests) {
+    // product state vector, the factors are permuted
+    ket a = randket(2), b = randket(3), c = randket(2), e = randket(3);
+    ket psi = kron(a, b, c, e);
+    std::vector<idx> dims{2, 3, 2, 3};
+    ket result = syspermute(psi, {3, 0, 2, 1}, dims);
+    EXPECT_NEAR(0, norm(result - kron(e, a, c, b)), 1e-7);
+    // consecutive subsystems moved together
+    result = syspermute(psi, {2, 3, 0, 1}, dims);
+    EXPECT_NEAR(0, norm(result - kron(c, e, a, b)), 1e-7);
+    // identity
+    EXPECT_NEAR(0, norm(syspermute(psi, {0, 1, 2, 3}, dims) - psi), 1e-7);
+
+    // product density matrix
+    cmat rhoA = randrho(2), rhoB = randrho(3), rhoC = randrho(2);
+    cmat rho = kron(rhoA, rhoB, rhoC);
+    cmat rho_result = syspermute(rho, {1, 2, 0}, {2, 3, 2});
+    EXPECT_NEAR(0, norm(rho_result - kron(rhoB, rhoC, rhoA)), 1e-7);
+
+    // qubits, more subsystems than one tile of the kernel
+    std::vector<ket> kets;
+    ket phi = ket::Ones(1), phi_rev = ket::Ones(1);
+    for (idx i = 0; i < 12; ++i)
+        kets.push_back(randket());
+    for (idx i = 0; i < 12; ++i) {
+        phi = kron(phi, kets[i]);
+        phi_rev = kron(phi_rev, kets[11 - i]);
+    }
+    std::vector<idx> rev{11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+    EXPECT_NEAR(0, norm(syspermute(phi, rev) - phi_rev), 1e-7);
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
 ///       qpp::syspermute(const Eigen::MatrixBase<Derived>& A,
@@ -288,3 +617,32 @@ TEST(qpp_syspermute, AllTests) {}
 ///       idx d = 2)
 TEST(qpp_syspermute_qubits, AllTests) {}
 /******************************************************************************/
+/// BEGIN template<typename Derived>
+///       Eigen::CwiseNullaryOp<internal::PermutedView<
+///       typename Derived::Scalar>, dyn_mat<typename Derived::Scalar>>
+///       qpp::syspermute_view(const Eigen::PlainObjectBase<Derived>& A,
+///       const std::vector<idx>& perm,
+///       const std::vector<idx>& dims)
+TEST(qpp_syspermute_view, AllTests) {
+    // same as the permuted copy, for state vectors and density matrices
+    std::vector<idx> dims{2, 3, 2, 3};
+    std::vector<idx> perm{3, 0, 2, 1};
+    ket psi = randket(36);
+    EXPECT_NEAR(0,
+                norm(cmat(syspermute_view(psi, perm, dims)) -
+                     syspermute(psi, perm, dims)),
+                1e-7);
+    cmat rho = randrho(36);
+    EXPECT_NEAR(0,
+                norm(cmat(syspermute_view(rho, perm, dims)) -
+                     syspermute(rho, perm, dims)),
+                1e-7);
+
+    // read-only use in an expression, no copy of the permuted state
+    ket phi = randket(8);
+    cplx overlap = (phi.adjoint() * syspermute_view(phi, {2, 0, 1})).value();
+    ket phi_perm = syspermute(phi, {2, 0, 1});
+    EXPECT_NEAR(0, std::abs(overlap - (phi.adjoint() * phi_perm).value()),
+                1e-7);
+}
+/******************************************************************************/
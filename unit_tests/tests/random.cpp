@@ -527,6 +527,36 @@ TEST(qpp_randU, AllTests) {
     EXPECT_NEAR(0, norm(U * adjoint(U) - gt.Id(D)), 1e-7);
 }
 /******************************************************************************/
+/// BEGIN inline std::vector<cmat> qpp::randU_batch(idx n, idx D = 2)
+TEST(qpp_randU_batch, AllTests) {
+    // D = 1 degenerate case
+    idx n = 3, D = 1;
+    std::vector<cmat> Us = qpp::randU_batch(n, D);
+    EXPECT_EQ(n, Us.size());
+    for (auto&& U : Us)
+        EXPECT_NEAR(0, norm(U * adjoint(U) - gt.Id(D)), 1e-7);
+
+    // D = 5, the unitaries are independent
+    n = 100, D = 5;
+    Us = qpp::randU_batch(n, D);
+    EXPECT_EQ(n, Us.size());
+    for (auto&& U : Us)
+        EXPECT_NEAR(0, norm(U * adjoint(U) - gt.Id(D)), 1e-7);
+    EXPECT_GT(norm(Us[0] - Us[1]), 1e-2);
+
+    // Haar moments, E|U_ij|^2 = 1/D
+    n = 2000, D = 4;
+    Us = qpp::randU_batch(n, D);
+    dmat avg = dmat::Zero(D, D);
+    for (auto&& U : Us)
+        avg += U.cwiseAbs2();
+    avg /= static_cast<double>(n);
+    EXPECT_NEAR(0, norm(avg - dmat::Constant(D, D, 1. / D)), 5e-2);
+
+    EXPECT_THROW(qpp::randU_batch(0, 2), exception::OutOfRange);
+    EXPECT_THROW(qpp::randU_batch(2, 0), exception::DimsInvalid);
+}
+/******************************************************************************/
 /// BEGIN inline cmat qpp::randV(idx Din, idx Dout)
 TEST(qpp_randV, AllTests) {
     // Din = 1, Dout = 1 degenerate case
@@ -548,5 +578,16 @@ TEST(qpp_randV, AllTests) {
     Din = 3, Dout = 5;
     V = qpp::randV(Din, Dout);
     EXPECT_NEAR(0, norm(adjoint(V) * V - gt.Id(Din)), 1e-7);
+
+    // Din = 2, Dout = 6, Haar moments, E|V_ij|^2 = 1/Dout
+    Din = 2, Dout = 6;
+    idx N = 2000;
+    dmat avg = dmat::Zero(Dout, Din);
+    for (idx i = 0; i < N; ++i)
+        avg += qpp::randV(Din, Dout).cwiseAbs2();
+    avg /= static_cast<double>(N);
+    EXPECT_NEAR(0, norm(avg - dmat::Constant(Dout, Din, 1. / Dout)), 5e-2);
+
+    EXPECT_THROW(qpp::randV(3, 2), exception::DimsInvalid);
 }
 /******************************************************************************/